@@ -127,47 +127,8 @@
                     surveyDetails.style.display = "none";
                 }
 
-                // Update Primary NTRIP status
-                const ntripConn1 = document.getElementById("ntripConnection1");
-                const ntripCard1 = document.getElementById("ntripCard1");
-                const ntripEnabled1 = document.getElementById("ntripEnabled1");
-                
-                // Always show NTRIP status regardless of enabled state
-                ntripEnabled1.textContent = data.enableCaster1 ? "Enabled" : "Disabled";
-                ntripEnabled1.className = data.enableCaster1 ? "status-label status-active" : "status-label status-inactive";
-                
-                if (data.ntripConnected1) {
-                    ntripConn1.textContent = "Connected";
-                    ntripConn1.className = "status-value status-active";
-                    ntripCard1.textContent = "Uptime: " + (data.ntripUptime1 || "--");
-                    ntripCard1.style.display = "block";
-                } else {
-                    ntripConn1.textContent = "Disconnected";
-                    ntripConn1.className = "status-value status-inactive";
-                    ntripCard1.textContent = "Uptime: --";
-                    ntripCard1.style.display = "block";
-                }
-
-                // Update Secondary NTRIP status
-                const ntripConn2 = document.getElementById("ntripConnection2");
-                const ntripCard2 = document.getElementById("ntripCard2");
-                const ntripEnabled2 = document.getElementById("ntripEnabled2");
-
-                // Always show NTRIP status regardless of enabled state
-                ntripEnabled2.textContent = data.enableCaster2 ? "Enabled" : "Disabled";
-                ntripEnabled2.className = data.enableCaster2 ? "status-label status-active" : "status-label status-inactive";
-
-                if (data.ntripConnected2) {
-                    ntripConn2.textContent = "Connected";
-                    ntripConn2.className = "status-value status-active";
-                    ntripCard2.textContent = "Uptime: " + (data.ntripUptime2 || "--");
-                    ntripCard2.style.display = "block";
-                } else {
-                    ntripConn2.textContent = "Disconnected";
-                    ntripConn2.className = "status-value status-inactive";
-                    ntripCard2.textContent = "Uptime: --";
-                    ntripCard2.style.display = "block";
-                }
+                // One row per caster slot
+                updateCasterStatus(data.casters || []);
             })
             .catch(error => console.error("Error fetching status:", error));
     }
@@ -241,8 +202,6 @@ function indexStart() {
     resetLoading();
     fetchSettings();
     initOtaUpdate();
-    initVersionToggles();
-    initCasterToggles(); // Initialize caster toggle event listeners
     
     // Initial status update
     updateStatus();
@@ -326,8 +285,8 @@ function enableForm() {
     }
 }
 
-function updateCasterFields(isPrimary, enabled) {
-    const suffix = isPrimary ? '1' : '2';
+function updateCasterFields(n, enabled) {
+    const suffix = String(n);
     const fields = [
         `casterHost${suffix}`,
         `casterPort${suffix}`,
@@ -374,34 +333,105 @@ function updateCasterFields(isPrimary, enabled) {
     });
 }
 
-// Add event listeners for caster enable toggles
-function initCasterToggles() {
-    const enableCaster1 = document.getElementById('enableCaster1');
-    const enableCaster2 = document.getElementById('enableCaster2');
-    
-    if (enableCaster1) {
-        enableCaster1.addEventListener('change', function() {
-            updateCasterFields(true, this.checked);
-        });
+// Caster slots in the settings (enableCaster1 .. enableCaster<n>), counted when they are loaded
+let casterCount = 0;
+
+function casterName(n) {
+    return n === 1 ? 'Primary' : n === 2 ? 'Secondary' : `Caster ${n}`;
+}
+
+// Slots are numbered from 1 without gaps, so the first missing enableCaster<n> ends them
+function countCasterSlots(data) {
+    let count = 0;
+    while (`enableCaster${count + 1}` in data) {
+        count++;
     }
-    
-    if (enableCaster2) {
-        enableCaster2.addEventListener('change', function() {
-            updateCasterFields(false, this.checked);
+    return count;
+}
+
+function casterSettingsHtml(n) {
+    const name = casterName(n);
+    return `
+        <h3 class="subsection-title">${name} NTRIP Connection</h3>
+        <div class="caster-header">
+            <div class="switch-container">
+                <label class="switch">
+                    <input type="checkbox" id="enableCaster${n}" name="enableCaster${n}">
+                    <span class="slider"></span>
+                </label>
+                <span class="switch-label">Enable ${name} Caster</span>
+            </div>
+            <div class="switch-container">
+                <label class="switch">
+                    <input type="checkbox" id="ntripVersion${n}" name="ntripVersion${n}">
+                    <span class="slider"></span>
+                </label>
+                <span class="switch-label">Use NTRIP 2.0</span>
+            </div>
+        </div>
+        <div class="form-row">
+            <div class="form-group">
+                <label for="casterHost${n}">Caster Host</label>
+                <input type="text" id="casterHost${n}" name="casterHost${n}" required>
+                <small>URL of the Caster server.</small>
+            </div>
+            <div class="form-group">
+                <label for="casterPort${n}">Caster Port</label>
+                <input type="number" id="casterPort${n}" name="casterPort${n}" min="1" max="65535" required>
+                <small>Port of the Caster server (1-65535).</small>
+            </div>
+        </div>
+
+        <div class="form-row">
+            <div class="form-group">
+                <label for="rtk_mntpnt${n}">Mountpoint</label>
+                <input type="text" id="rtk_mntpnt${n}" name="rtk_mntpnt${n}" required>
+                <small>NTRIP caster mountpoint.</small>
+            </div>
+            <div class="form-group">
+                <label for="rtk_mntpnt_user${n}">Username</label>
+                <input type="text" id="rtk_mntpnt_user${n}" name="rtk_mntpnt_user${n}" maxlength="15" required>
+                <small>Username (required for NTRIP 2.0, max 15 characters).</small>
+            </div>
+            <div class="form-group">
+                <label for="rtk_mntpnt_pw${n}">Password</label>
+                <div class="password-container">
+                    <input type="password" id="rtk_mntpnt_pw${n}" name="rtk_mntpnt_pw${n}" required>
+                    <button type="button" class="password-toggle" onclick="togglePassword('rtk_mntpnt_pw${n}')" tabindex="-1"></button>
+                </div>
+                <small>Mountpoint password.</small>
+            </div>
+        </div>`;
+}
+
+// One form section per caster slot, with its enable and version toggles wired up
+function renderCasterSettings(count) {
+    const container = document.getElementById('casterSettings');
+    container.innerHTML = '';
+    for (let n = 1; n <= count; n++) {
+        container.insertAdjacentHTML('beforeend', casterSettingsHtml(n));
+        initCasterToggle(n);
+        initVersionToggle(n);
+    }
+}
+
+function initCasterToggle(n) {
+    const enableCaster = document.getElementById(`enableCaster${n}`);
+    if (enableCaster) {
+        enableCaster.addEventListener('change', function() {
+            updateCasterFields(n, this.checked);
         });
     }
 }
 
-function initVersionToggles() {
-    const version1Toggle = document.getElementById('ntripVersion1');
-    const version2Toggle = document.getElementById('ntripVersion2');
-    const user1Input = document.getElementById('rtk_mntpnt_user1');
-    const user2Input = document.getElementById('rtk_mntpnt_user2');
+function initVersionToggle(n) {
+    const versionToggle = document.getElementById(`ntripVersion${n}`);
+    const userInput = document.getElementById(`rtk_mntpnt_user${n}`);
 
-    function updateUsernameField(toggle, userInput) {
-        if (!toggle || !userInput) return;
+    function updateUsernameField() {
+        if (!versionToggle || !userInput) return;
 
-        const isVersion2 = toggle.checked;
+        const isVersion2 = versionToggle.checked;
         userInput.disabled = !isVersion2;
 
         // Clear value and remove required when disabled (NTRIP 1.0 doesn't use username)
@@ -413,23 +443,55 @@ function initVersionToggles() {
         }
     }
 
-    if (version1Toggle) {
-        version1Toggle.addEventListener('change', function() {
-            console.log('Primary NTRIP version changed:', this.checked ? '2.0' : '1.0');
-            updateUsernameField(this, user1Input);
+    if (versionToggle) {
+        versionToggle.addEventListener('change', function() {
+            console.log(`${casterName(n)} NTRIP version changed:`, this.checked ? '2.0' : '1.0');
+            updateUsernameField();
         });
         // Initialize on page load
-        updateUsernameField(version1Toggle, user1Input);
+        updateUsernameField();
     }
+}
 
-    if (version2Toggle) {
-        version2Toggle.addEventListener('change', function() {
-            console.log('Secondary NTRIP version changed:', this.checked ? '2.0' : '1.0');
-            updateUsernameField(this, user2Input);
-        });
-        // Initialize on page load
-        updateUsernameField(version2Toggle, user2Input);
+function casterStatusHtml(n) {
+    return `
+        <div class="ntrip-connection">
+            <div class="connection-label">${casterName(n)}:</div>
+            <div class="status-label" id="ntripEnabled${n}">Disabled</div>
+            <div class="status-value" id="ntripConnection${n}">--</div>
+            <div class="status-label" id="ntripCard${n}" style="display: none;">--</div>
+        </div>`;
+}
+
+// casters is the array of /status, one entry per slot
+function updateCasterStatus(casters) {
+    const container = document.getElementById("ntripStatus");
+    if (container.children.length !== casters.length) {
+        container.innerHTML = "";
+        casters.forEach((caster, i) => container.insertAdjacentHTML("beforeend", casterStatusHtml(i + 1)));
     }
+
+    casters.forEach((caster, i) => {
+        const n = i + 1;
+        const ntripConn = document.getElementById(`ntripConnection${n}`);
+        const ntripCard = document.getElementById(`ntripCard${n}`);
+        const ntripEnabled = document.getElementById(`ntripEnabled${n}`);
+
+        // Always show NTRIP status regardless of enabled state
+        ntripEnabled.textContent = caster.enabled ? "Enabled" : "Disabled";
+        ntripEnabled.className = caster.enabled ? "status-label status-active" : "status-label status-inactive";
+
+        if (caster.connected) {
+            ntripConn.textContent = "Connected";
+            ntripConn.className = "status-value status-active";
+            ntripCard.textContent = "Uptime: " + (caster.uptime || "--");
+        } else {
+            ntripConn.textContent = "Disconnected";
+            ntripConn.className = "status-value status-inactive";
+            ntripCard.textContent = "Uptime: --";
+        }
+        ntripCard.style.display = "block";
+    });
 }
 
 function updateFormValues(data) {
@@ -447,27 +509,21 @@ function updateFormValues(data) {
             }
         };
 
-        // Update primary caster settings
-        safeSetValue('enableCaster1', data.enableCaster1);
+        // One section per caster slot in the settings
+        casterCount = countCasterSlots(data);
+        renderCasterSettings(casterCount);
+
         safeSetValue('ntrip_sName', data.ntrip_sName);
-        
-        // Handle version settings
-        safeSetValue('ntripVersion1', data.ntripVersion1 === 2 || data.ntripVersion1 === '2' || data.ntripVersion1 === true);
-        safeSetValue('ntripVersion2', data.ntripVersion2 === 2 || data.ntripVersion2 === '2' || data.ntripVersion2 === true);
-        
-        safeSetValue('casterHost1', data.casterHost1);
-        safeSetValue('casterPort1', data.casterPort1);
-        safeSetValue('rtk_mntpnt1', data.rtk_mntpnt1);
-        safeSetValue('rtk_mntpnt_user1', data.rtk_mntpnt_user1);
-        safeSetValue('rtk_mntpnt_pw1', data.rtk_mntpnt_pw1);
-        
-        // Update secondary caster settings
-        safeSetValue('enableCaster2', data.enableCaster2);
-        safeSetValue('casterHost2', data.casterHost2);
-        safeSetValue('casterPort2', data.casterPort2);
-        safeSetValue('rtk_mntpnt2', data.rtk_mntpnt2);
-        safeSetValue('rtk_mntpnt_user2', data.rtk_mntpnt_user2);
-        safeSetValue('rtk_mntpnt_pw2', data.rtk_mntpnt_pw2);
+        for (let n = 1; n <= casterCount; n++) {
+            safeSetValue(`enableCaster${n}`, data[`enableCaster${n}`]);
+            const version = data[`ntripVersion${n}`];
+            safeSetValue(`ntripVersion${n}`, version === 2 || version === '2' || version === true);
+            safeSetValue(`casterHost${n}`, data[`casterHost${n}`]);
+            safeSetValue(`casterPort${n}`, data[`casterPort${n}`]);
+            safeSetValue(`rtk_mntpnt${n}`, data[`rtk_mntpnt${n}`]);
+            safeSetValue(`rtk_mntpnt_user${n}`, data[`rtk_mntpnt_user${n}`]);
+            safeSetValue(`rtk_mntpnt_pw${n}`, data[`rtk_mntpnt_pw${n}`]);
+        }
         
         // Update RTCM checks setting
         safeSetValue('enableRtcmChecks', data.rtcmChk);
@@ -486,16 +542,13 @@ function updateFormValues(data) {
             safeSetValue('ecefZ', ecefZ);
         }
         
-        // Update field states based on enable settings
-        updateCasterFields(true, !!data.enableCaster1);
-        updateCasterFields(false, !!data.enableCaster2);
-
-        // Trigger username field updates based on loaded NTRIP versions
-        // This ensures username fields are properly disabled for NTRIP 1.0
-        const version1Toggle = document.getElementById('ntripVersion1');
-        const version2Toggle = document.getElementById('ntripVersion2');
-        if (version1Toggle) version1Toggle.dispatchEvent(new Event('change'));
-        if (version2Toggle) version2Toggle.dispatchEvent(new Event('change'));
+        // Update field states based on enable settings, and trigger username field updates
+        // based on the loaded NTRIP versions so they are disabled for NTRIP 1.0
+        for (let n = 1; n <= casterCount; n++) {
+            updateCasterFields(n, !!data[`enableCaster${n}`]);
+            const versionToggle = document.getElementById(`ntripVersion${n}`);
+            if (versionToggle) versionToggle.dispatchEvent(new Event('change'));
+        }
 
         // Enable the form after data is loaded
         enableForm();
@@ -509,35 +562,22 @@ function updateFormValues(data) {
 function validateFormInputs() {
     const errors = [];
 
-    // Validate port numbers (1-65535)
-    const port1 = document.getElementById('casterPort1').value;
-    const port2 = document.getElementById('casterPort2').value;
-
-    if (document.getElementById('enableCaster1').checked) {
-        const portNum1 = parseInt(port1);
-        if (isNaN(portNum1) || portNum1 < 1 || portNum1 > 65535) {
-            errors.push('Primary caster port must be between 1 and 65535');
+    for (let n = 1; n <= casterCount; n++) {
+        // Validate port numbers (1-65535)
+        if (document.getElementById(`enableCaster${n}`).checked) {
+            const portNum = parseInt(document.getElementById(`casterPort${n}`).value);
+            if (isNaN(portNum) || portNum < 1 || portNum > 65535) {
+                errors.push(`${casterName(n)} caster port must be between 1 and 65535`);
+            }
         }
-    }
 
-    if (document.getElementById('enableCaster2').checked) {
-        const portNum2 = parseInt(port2);
-        if (isNaN(portNum2) || portNum2 < 1 || portNum2 > 65535) {
-            errors.push('Secondary caster port must be between 1 and 65535');
+        // Validate username length (max 15 characters)
+        const user = document.getElementById(`rtk_mntpnt_user${n}`).value;
+        if (user && user.length > 15) {
+            errors.push(`${casterName(n)} username must be 15 characters or less`);
         }
     }
 
-    // Validate username length (max 15 characters)
-    const user1 = document.getElementById('rtk_mntpnt_user1').value;
-    const user2 = document.getElementById('rtk_mntpnt_user2').value;
-
-    if (user1 && user1.length > 15) {
-        errors.push('Primary username must be 15 characters or less');
-    }
-    if (user2 && user2.length > 15) {
-        errors.push('Secondary username must be 15 characters or less');
-    }
-
     // Validate ECEF coordinates (±7000 km = ±700000 cm)
     const ecefX = parseFloat(document.getElementById('ecefX').value);
     const ecefY = parseFloat(document.getElementById('ecefY').value);
@@ -577,12 +617,14 @@ document.querySelector('.settings-form').addEventListener('submit', function(e)
     
     // Add all basic fields
     formData.append('ntrip_sName', document.getElementById('ntrip_sName').value);
-    formData.append('ntripVersion1', document.getElementById('ntripVersion1').checked ? '2' : '1'); // Convert boolean to version number
-    formData.append('ntripVersion2', document.getElementById('ntripVersion2').checked ? '2' : '1'); // Convert boolean to version number
+    for (let n = 1; n <= casterCount; n++) {
+        formData.append(`ntripVersion${n}`, document.getElementById(`ntripVersion${n}`).checked ? '2' : '1'); // Convert boolean to version number
+    }
     
-    // Add enable flags for both casters and RTCM checks
-    formData.append('enableCaster1', document.getElementById('enableCaster1').checked ? 'on' : '');
-    formData.append('enableCaster2', document.getElementById('enableCaster2').checked ? 'on' : '');
+    // Add enable flags for every caster and RTCM checks
+    for (let n = 1; n <= casterCount; n++) {
+        formData.append(`enableCaster${n}`, document.getElementById(`enableCaster${n}`).checked ? 'on' : '');
+    }
     formData.append('rtcmChk', document.getElementById('enableRtcmChecks').checked ? 'on' : '');
     
     // Add ECEF coordinates - convert from centimeters with 0.1mm precision to 0.1mm precision integers
@@ -595,22 +637,14 @@ document.querySelector('.settings-form').addEventListener('submit', function(e)
     formData.append('ecefY', Math.round(ecefY * 100).toString());
     formData.append('ecefZ', Math.round(ecefZ * 100).toString());
     
-    // Add primary caster fields if enabled
-    if (document.getElementById('enableCaster1').checked) {
-        formData.append('casterHost1', document.getElementById('casterHost1').value);
-        formData.append('casterPort1', document.getElementById('casterPort1').value);
-        formData.append('rtk_mntpnt1', document.getElementById('rtk_mntpnt1').value);
-        formData.append('rtk_mntpnt_user1', document.getElementById('rtk_mntpnt_user1').value);
-        formData.append('rtk_mntpnt_pw1', document.getElementById('rtk_mntpnt_pw1').value);
-    }
-    
-    // Add secondary caster fields if enabled
-    if (document.getElementById('enableCaster2').checked) {
-        formData.append('casterHost2', document.getElementById('casterHost2').value);
-        formData.append('casterPort2', document.getElementById('casterPort2').value);
-        formData.append('rtk_mntpnt2', document.getElementById('rtk_mntpnt2').value);
-        formData.append('rtk_mntpnt_user2', document.getElementById('rtk_mntpnt_user2').value);
-        formData.append('rtk_mntpnt_pw2', document.getElementById('rtk_mntpnt_pw2').value);
+    // Add the fields of each enabled caster
+    for (let n = 1; n <= casterCount; n++) {
+        if (!document.getElementById(`enableCaster${n}`).checked) {
+            continue;
+        }
+        [`casterHost${n}`, `casterPort${n}`, `rtk_mntpnt${n}`, `rtk_mntpnt_user${n}`, `rtk_mntpnt_pw${n}`].forEach(id => {
+            formData.append(id, document.getElementById(id).value);
+        });
     }
     
     // Show loading overlay
@@ -41,6 +41,8 @@
 #define GPS_STATUS_TASK_PRIORITY configMAX_PRIORITIES - 3 //     = 22
 #define GPS_UART_CHECK_TASK_PRIORITY configMAX_PRIORITIES - 2 // = 23
 #define NTRIP_TASK_PRIORITY 1 //                                 =  1
+#define LOCAL_CASTER_TASK_PRIORITY 1 //                          =  1
+#define UDP_OUTPUT_TASK_PRIORITY 1 //                            =  1
 #define WEB_SERVER_TASK_PRIORITY 10 //                           = 10
 // AsyncTCP task priority                                        =  3
 // W6100 task priority (rx)                                      =  1
@@ -48,17 +50,21 @@
 // Task Stack Sizes (bytes)
 #define GPS_STATUS_TASK_STACK 4096       // Stack for GPS status monitoring task
 #define GPS_UART_CHECK_TASK_STACK 10000  // Stack for GPS UART check task (high-frequency RTCM processing)
-#define NTRIP_TASK_STACK 8192            // Stack for NTRIP client task
+#define NTRIP_TASK_STACK 8192            // Stack for each NTRIP caster task
 #define WEB_SERVER_TASK_STACK 8192       // Stack for web server task
+#define LOCAL_CASTER_TASK_STACK 6144     // Stack for each LAN server task (local caster, raw TCP server)
+#define UDP_OUTPUT_TASK_STACK 4096       // Stack for the UDP RTCM output task
 
 // Timeout Constants (milliseconds)
 #define WATCHDOG_TIMEOUT_MS 30000       // Watchdog timer timeout (30 seconds)
 #define DHCP_TIMEOUT_MS 30000           // DHCP initialization timeout (30 seconds)
-#define NTRIP_CONNECTION_TIMEOUT_MS 10000    // NTRIP server connection timeout (10 seconds)
-#define NTRIP_RECONNECT_DELAY_MS 5000        // Delay between NTRIP reconnection attempts (5 seconds)
+#define NTRIP_CONNECTION_TIMEOUT_MS 10000    // NTRIP connect + handshake timeout (10 seconds)
+#define NTRIP_RECONNECT_DELAY_MS 5000        // NTRIP reconnect backoff after the first failure (5 seconds)
+#define NTRIP_MAX_RECONNECT_DELAY_MS 60000   // NTRIP reconnect backoff cap (1 minute)
 #define NTRIP_STABILITY_TIMEOUT_MS 5000      // Time before NTRIP connection considered stable (5 seconds)
 #define NTRIP_RTCM_TIMEOUT_MS 10000          // Timeout for receiving RTCM data (10 seconds)
 #define NTRIP_HEALTH_CHECK_INTERVAL_MS 5000  // Interval for NTRIP health checks (5 seconds)
+#define NTRIP_WRITE_STALL_MS 3000            // Default caster write stall threshold (setting stallTimeout)
 #define UPTIME_PRINT_INTERVAL_MS 300000      // System uptime print interval (5 minutes)
 
 // GPS Constants
@@ -67,6 +73,52 @@
 
 // Buffer Sizes
 #define NTRIP_SERVER_BUFFER_SIZE 1024   // Buffer size for NTRIP server requests
+#define RTCM_STAGE_BUFFER_SIZE 1024     // RTCM bytes staged from processRTCM() before bulk framing
+#define GNSS_UART_READ_SIZE 1024        // Bytes per bulk read from the GNSS UART
+#define GNSS_UBX_MAX_LEN 1024           // Longest UBX frame the UART demultiplexer hands to the library
+#define GNSS_NMEA_MAX_LEN 128           // Longest NMEA sentence the UART demultiplexer accepts
+#define CASTER_QUEUE_DEPTH 8            // Frames queued per caster before new frames are dropped
+#define CASTER_MAX_HELD_FRAMES 12       // Frame pool slots one caster may hold (queued + coalescing), more are dropped for it alone
+#define CASTER_MAX_FRAME_AGE_MS 2000    // Queued frames older than this are discarded instead of sent
+#define CASTER_EPOCH_MAX_FRAMES 12      // Frames coalesced into one write before it's sent regardless
+#define CASTER_EPOCH_DEADLINE_MS 100    // Send a coalesced epoch at the latest this long after its first frame
+
+// Caster output slots (settings keys enableCaster<n>, casterHost<n>, ... with n = 1..NTRIP_CASTER_COUNT).
+// Cost per slot, linear in the slot count:
+//   - always: ~1.7 kB of state: WiFiClient, status and counters (~200 B), the 256 B handshake reply
+//     buffer, the message filter table and rules (~700 B, RtcmFilter) and the correction age
+//     histogram (456 B, AgeHistogram)
+//     + (CASTER_QUEUE_DEPTH + CASTER_EPOCH_MAX_FRAMES) * 8 B of queued/pending frame references
+//     + ~600 B of the settings document and ~720 B of each /status document (settings.cpp, web_server.cpp)
+//   - enabled: one NTRIP_TASK_STACK task (8 kB), one lwIP socket (CONFIG_LWIP_MAX_SOCKETS) and
+//     CASTER_MAX_HELD_FRAMES frame pool slots (~12 kB of heap), see RTCM_FRAME_POOL_SLOTS
+//   - connected: a queue push + task notify per frame in the GNSS UART task and one TCP write
+//     per frame in the caster's task
+#define NTRIP_CASTER_COUNT 5
+
+// LAN servers for local rovers: the NTRIP caster (settings localCaster, localCasterPort, localMount)
+// and the raw TCP server (tcpServer, tcpServerPort). The limits below apply to each server.
+// Cost per client: RtcmServer::memoryPerClient() (~400 B: socket, request buffer, queue of
+// LOCAL_CLIENT_QUEUE_DEPTH frame references) and one lwIP socket. Frames are shared with the
+// other outputs; all clients together hold at most LOCAL_CASTER_INPUT_DEPTH + LOCAL_CLIENT_QUEUE_DEPTH
+// pool slots.
+#define LOCAL_CASTER_MAX_CLIENTS 8
+#define LOCAL_CASTER_INPUT_DEPTH 8          // Frames queued from the GNSS UART task to a LAN server task
+#define LOCAL_CLIENT_QUEUE_DEPTH 8          // Frames queued per rover before it's disconnected as too slow
+#define LOCAL_CASTER_REQUEST_SIZE 256       // Longest accepted HTTP request
+#define LOCAL_CASTER_REQUEST_TIMEOUT_MS 5000  // Close connections that don't complete a request in time
+
+// RTCM frames in flight between the framer and the outputs, 1040 B of heap per slot. There is room
+// for every holder at its limit at once, so a stalled output runs into its own limit and never takes
+// the slot the framer needs for everybody else's next frame: CASTER_MAX_HELD_FRAMES per enabled
+// caster, per enabled LAN server its input ring plus one client queue (clients share frames), the
+// UDP output its input ring plus one epoch, and 9 for the station metadata cache (4), injected
+// messages (2), the framer (2 while it hands a frame over) and an MSM4 conversion (1). The pool is
+// allocated at startup for the outputs enabled in the settings (frame_pool_budget::slots_for() in
+// rtcm_output.h); this is the count with every output on, 121 slots with the defaults above.
+#define RTCM_FRAME_POOL_SLOTS (NTRIP_CASTER_COUNT * CASTER_MAX_HELD_FRAMES + \
+                               2 * (LOCAL_CASTER_INPUT_DEPTH + LOCAL_CLIENT_QUEUE_DEPTH) + \
+                               LOCAL_CASTER_INPUT_DEPTH + CASTER_EPOCH_MAX_FRAMES + 9)
 
 
 #endif // DEFINES_H_
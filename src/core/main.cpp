@@ -8,6 +8,8 @@
 #include "hardware/gps.h"
 #include "utils/settings.h"
 #include "network/ntrip.h"
+#include "network/rtcm_server.h"
+#include "network/rtcm_udp.h"
 #include "utils/system_status.h"
 #include "WebServer_ESP32_SC_W6100.h"
 #include "esp_task_wdt.h"
@@ -41,6 +43,10 @@ bool initialize_systems() {
     debug("GPS initialized");
     ntrip_handle_init();
     debug("NTRIP initialized");
+    local_caster_init();
+    debug("LAN servers initialized");
+    udp_output_init();
+    debug("UDP output initialized");
     return true;
 }
 
@@ -87,6 +93,9 @@ void loop()
         TaskHandle_t gpsUartTaskHandle = xTaskGetHandle("gpsUartTask");
         TaskHandle_t ntripTaskHandle = xTaskGetHandle("NTRIPTask");
         TaskHandle_t webServerTaskHandle = xTaskGetHandle("WebServerTask");
+        TaskHandle_t localCasterTaskHandle = xTaskGetHandle("LocalCasterTask");
+        TaskHandle_t tcpServerTaskHandle = xTaskGetHandle("TcpServerTask");
+        TaskHandle_t udpOutputTaskHandle = xTaskGetHandle("UdpOutputTask");
 
         if (gpsStatusTaskHandle) {
             UBaseType_t watermark = uxTaskGetStackHighWaterMark(gpsStatusTaskHandle);
@@ -104,6 +113,18 @@ void loop()
             UBaseType_t watermark = uxTaskGetStackHighWaterMark(webServerTaskHandle);
             debugf("Stack watermark - WebServerTask: %u bytes free (configured: %u)", watermark, WEB_SERVER_TASK_STACK);
         }
+        if (localCasterTaskHandle) {
+            UBaseType_t watermark = uxTaskGetStackHighWaterMark(localCasterTaskHandle);
+            debugf("Stack watermark - LocalCasterTask: %u bytes free (configured: %u)", watermark, LOCAL_CASTER_TASK_STACK);
+        }
+        if (tcpServerTaskHandle) {
+            UBaseType_t watermark = uxTaskGetStackHighWaterMark(tcpServerTaskHandle);
+            debugf("Stack watermark - TcpServerTask: %u bytes free (configured: %u)", watermark, LOCAL_CASTER_TASK_STACK);
+        }
+        if (udpOutputTaskHandle) {
+            UBaseType_t watermark = uxTaskGetStackHighWaterMark(udpOutputTaskHandle);
+            debugf("Stack watermark - UdpOutputTask: %u bytes free (configured: %u)", watermark, UDP_OUTPUT_TASK_STACK);
+        }
     }
 
     // Use shorter delay for more responsive shutdown
@@ -0,0 +1,302 @@
+//
+// Single-pass demultiplexer for the GNSS UART, which carries UBX, NMEA and
+// RTCM 3 interleaved.
+//
+// Every byte is looked at once, on the way to one of three handlers:
+//   RTCM  0xD3 and a header with the 6 reserved bits clear. The 10-bit length
+//         gives the frame end. Collected, CRC24Q checked, complete frames go
+//         to Handler::rtcm().
+//   UBX   0xB5 0x62, class, id, 16-bit little-endian length. Collected up to
+//         MaxUbxLen, Fletcher checked, complete frames go to Handler::ubx().
+//   NMEA  '$' up to '\n', printable ASCII, at most MaxNmeaLen. Checked against
+//         its *hh checksum, complete sentences go to Handler::nmea().
+// Bytes between frames are skipped and counted. A header that doesn't fit its
+// protocol, or an RTCM candidate that fails its CRC, costs its first byte only:
+// the rest is scanned again, so a frame starting inside it isn't missed. A 0xD3
+// in UBX or NMEA data can't swallow the frames behind it.
+//
+// Handler is any type with
+//   void rtcm(const uint8_t *frame, size_t len);  // Complete frame, preamble to CRC
+//   void ubx(const uint8_t *frame, size_t len);   // Complete frame, sync to checksum
+//   void nmea(const uint8_t *sentence, size_t len);  // '$' to '\n'
+// Not thread safe: feed an instance from one task.
+//
+
+#ifndef GNSS_DEMUX_H
+#define GNSS_DEMUX_H
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "network/crc24q.h"
+
+template <size_t MaxUbxLen, size_t MaxNmeaLen, typename Handler>
+class GnssDemux {
+    static_assert(MaxUbxLen >= 8, "MaxUbxLen must hold at least an empty UBX frame");
+    static_assert(MaxNmeaLen <= MaxUbxLen, "NMEA sentences are collected in the UBX buffer");
+
+public:
+    enum Protocol {
+        RTCM,
+        UBX,
+        NMEA,
+        PROTOCOLS
+    };
+
+    // Since construction or clear_stats()
+    struct Stats {
+        uint32_t bytes[PROTOCOLS];   // Frames delivered
+        uint32_t frames[PROTOCOLS];
+        uint32_t rtcm_errors;        // Bad CRC
+        uint32_t ubx_errors;         // Bad checksum or longer than MaxUbxLen
+        uint32_t nmea_errors;        // Bad checksum, too long, or cut short by binary data
+        uint32_t bytes_skipped;      // Between frames, and the frames behind the errors
+    };
+
+    explicit GnssDemux(Handler handler = Handler()) : handler(handler) {
+        drop_partial();
+        clear_stats();
+    }
+
+    // Forget a frame in progress, e.g. after another reader took bytes from the UART
+    void drop_partial() {
+        state = IDLE;
+        collected = 0;
+        remaining = 0;
+        rejected = false;
+    }
+
+    void clear_stats() {
+        stats = Stats();
+    }
+
+    const Stats &get_stats() const {
+        return stats;
+    }
+
+    void process(const uint8_t *data, size_t len) {
+        while (len > 0) {
+            const size_t used = scan(data, len);
+            data += used;
+            len -= used;
+            if (rejected) {
+                rescan();
+            }
+        }
+    }
+
+private:
+    static constexpr uint8_t RTCM_PREAMBLE = 0xD3;
+    static constexpr size_t RTCM_MAX_LEN = 3 + 1023 + 3;  // Header, longest payload, CRC
+    static constexpr uint8_t UBX_SYNC1 = 0xB5;
+    static constexpr uint8_t UBX_SYNC2 = 0x62;
+    static constexpr size_t UBX_HEADER_LEN = 6;  // Sync, class, id, length
+    static constexpr size_t BUFFER_LEN = MaxUbxLen > RTCM_MAX_LEN ? MaxUbxLen : RTCM_MAX_LEN;
+
+    enum State {
+        IDLE,
+        RTCM_HEADER,
+        RTCM_BODY,
+        UBX_FRAME,
+        NMEA_SENTENCE
+    };
+
+    Handler handler;
+    uint8_t buffer[BUFFER_LEN];  // RTCM, UBX frame or NMEA sentence being collected
+    State state;
+    size_t collected;  // Bytes in buffer
+    size_t remaining;  // RTCM and UBX: frame length
+    bool rejected;     // The candidate in buffer belongs to no frame, see reject()
+    Stats stats;
+
+    // Run the state machine over data until it ends or a candidate is rejected, returns the bytes used.
+    // Only ever writes buffer behind where it reads, so it can scan buffer itself.
+    size_t scan(const uint8_t *data, size_t len) {
+        const size_t total = len;
+        while (len > 0 && !rejected) {
+            switch (state) {
+                case IDLE: {
+                    size_t skip = 0;
+                    while (skip < len && data[skip] != RTCM_PREAMBLE && data[skip] != UBX_SYNC1 && data[skip] != '$') {
+                        skip++;
+                    }
+                    stats.bytes_skipped += skip;
+                    data += skip;
+                    len -= skip;
+                    if (len == 0) {
+                        return total;
+                    }
+                    buffer[0] = *data++;
+                    len--;
+                    collected = 1;
+                    state = buffer[0] == RTCM_PREAMBLE ? RTCM_HEADER : (buffer[0] == UBX_SYNC1 ? UBX_FRAME : NMEA_SENTENCE);
+                    break;
+                }
+
+                case RTCM_HEADER:
+                    buffer[collected++] = *data++;
+                    len--;
+                    if (collected == 3) {
+                        if (buffer[1] & 0xFC) {
+                            reject();
+                            break;
+                        }
+                        // Header, payload and CRC
+                        remaining = 3 + (((buffer[1] & 0x03) << 8) | buffer[2]) + 3;
+                        state = RTCM_BODY;
+                    }
+                    break;
+
+                case RTCM_BODY: {
+                    size_t take = remaining - collected;
+                    if (take > len) {
+                        take = len;
+                    }
+                    memmove(&buffer[collected], data, take);
+                    collected += take;
+                    data += take;
+                    len -= take;
+                    if (collected == remaining) {
+                        deliver_rtcm();
+                    }
+                    break;
+                }
+
+                case UBX_FRAME: {
+                    if (collected < UBX_HEADER_LEN) {
+                        buffer[collected++] = *data++;
+                        len--;
+                        if (collected == 2 && buffer[1] != UBX_SYNC2) {
+                            reject();
+                        } else if (collected == UBX_HEADER_LEN) {
+                            remaining = UBX_HEADER_LEN + (buffer[4] | (buffer[5] << 8)) + 2;
+                            if (remaining > MaxUbxLen) {
+                                stats.ubx_errors++;
+                                reject();
+                            }
+                        }
+                        break;
+                    }
+                    size_t take = remaining - collected;
+                    if (take > len) {
+                        take = len;
+                    }
+                    memmove(&buffer[collected], data, take);
+                    collected += take;
+                    data += take;
+                    len -= take;
+                    if (collected == remaining) {
+                        deliver_ubx();
+                        state = IDLE;
+                    }
+                    break;
+                }
+
+                case NMEA_SENTENCE: {
+                    const uint8_t c = *data;
+                    if ((c < 0x20 && c != '\r' && c != '\n') || c >= 0x7F || collected == MaxNmeaLen) {
+                        // Not a sentence after all, or binary data cut it short: c may start the next frame
+                        stats.nmea_errors++;
+                        stats.bytes_skipped += collected;
+                        state = IDLE;
+                        break;
+                    }
+                    buffer[collected++] = c;
+                    data++;
+                    len--;
+                    if (c == '\n') {
+                        deliver_nmea();
+                        state = IDLE;
+                    }
+                    break;
+                }
+            }
+        }
+        return total - len;
+    }
+
+    // The candidate in buffer belongs to no frame, scan() stops and process() calls rescan()
+    void reject() {
+        rejected = true;
+    }
+
+    // Skip the rejected candidate's first byte and scan the rest again, in place, ahead of any
+    // input still to come. A candidate rejected in there leaves its own bytes after the first
+    // followed by what this pass hadn't reached yet, moved down to sit right behind them.
+    void rescan() {
+        size_t count = collected - 1;
+        while (rejected) {
+            rejected = false;
+            stats.bytes_skipped++;
+            state = IDLE;
+            collected = 0;
+            const size_t used = scan(&buffer[1], count);
+            if (rejected) {
+                const size_t left = count - used;
+                memmove(&buffer[collected], &buffer[1 + used], left);
+                count = collected - 1 + left;
+            }
+        }
+    }
+
+    void deliver_rtcm() {
+        const uint32_t expected = ((uint32_t)buffer[collected - 3] << 16) | (buffer[collected - 2] << 8) | buffer[collected - 1];
+        if (crc24q::compute(buffer, collected - 3) != expected) {
+            // A 0xD3 in other data, or a damaged frame: what follows its first byte may hold real frames
+            stats.rtcm_errors++;
+            reject();
+            return;
+        }
+        stats.bytes[RTCM] += collected;
+        stats.frames[RTCM]++;
+        state = IDLE;
+        handler.rtcm(buffer, collected);
+    }
+
+    void deliver_ubx() {
+        uint8_t ck_a = 0;
+        uint8_t ck_b = 0;
+        for (size_t i = 2; i < collected - 2; i++) {
+            ck_a += buffer[i];
+            ck_b += ck_a;
+        }
+        if (ck_a != buffer[collected - 2] || ck_b != buffer[collected - 1]) {
+            stats.ubx_errors++;
+            stats.bytes_skipped += collected;
+            return;
+        }
+        stats.bytes[UBX] += collected;
+        stats.frames[UBX]++;
+        handler.ubx(buffer, collected);
+    }
+
+    static int hex_value(const uint8_t c) {
+        if (c >= '0' && c <= '9') {
+            return c - '0';
+        }
+        if (c >= 'A' && c <= 'F') {
+            return c - 'A' + 10;
+        }
+        return -1;
+    }
+
+    void deliver_nmea() {
+        // $<body>*hh\r\n, the checksum XORs the body
+        uint8_t checksum = 0;
+        size_t i = 1;
+        while (i < collected && buffer[i] != '*') {
+            checksum ^= buffer[i++];
+        }
+        const bool valid = i + 2 < collected && hex_value(buffer[i + 1]) >= 0 && hex_value(buffer[i + 2]) >= 0 &&
+                           (hex_value(buffer[i + 1]) << 4 | hex_value(buffer[i + 2])) == checksum;
+        if (!valid) {
+            stats.nmea_errors++;
+            stats.bytes_skipped += collected;
+            return;
+        }
+        stats.bytes[NMEA] += collected;
+        stats.frames[NMEA]++;
+        handler.nmea(buffer, collected);
+    }
+};
+
+#endif //GNSS_DEMUX_H
@@ -2,6 +2,9 @@
 #include "gps.h"
 #include "utils/log.h"
 #include "utils/settings.h"
+#include "network/ntrip.h"
+#include "network/rtcm_inject.h"
+#include "gnss_demux.h"
 #include <SparkFun_u-blox_GNSS_Arduino_Library.h>
 #include <core/defines.h>
 
@@ -18,6 +21,7 @@ unsigned long gpsInitTime;
 String gpsStatusSting;
 
 GPSStatusStruct currentGPSStatus;
+GnssClock gnssClock;
 
 GPSMode getGpsMode();
 
@@ -32,8 +36,9 @@ bool prev_survey_in_active = false;
 // 1. gpsStatusTask: Updates GPS status every 1 second (slow)
 // 2. gps_uart_check_task: Processes incoming RTCM data from GPS UART (fast)
 //
-// Problem: myGNSS.checkUblox() and other GPS operations (getSurveyMode, etc.)
-// cannot run concurrently - they're not thread-safe and share the same UART.
+// Problem: reading the UART (gps_uart_check_task's own reads, myGNSS.checkUblox())
+// and other GPS operations (getSurveyMode, etc.) cannot run concurrently - they're
+// not thread-safe and share the same UART.
 //
 // Solution: fast_uart_handle acts as a mutex-like flag:
 // - When TRUE: gps_uart_check_task actively polls UART at high frequency (1ms)
@@ -50,6 +55,88 @@ void enable_fast_uart();
 bool configureGPS();
 bool updateGPSStatus();
 
+// Runs from checkCallbacks() in gps_uart_check_task, right after the demultiplexer
+// handed over the PVT frame, so millis() is close to when it arrived
+void onNavPvt(UBX_NAV_PVT_data_t *pvt) {
+    if (pvt->valid.bits.validTime) {
+        gnssClock.set(pvt->iTOW, millis());
+    }
+}
+
+// In fast mode gps_uart_check_task reads Serial1 in bulk and splits the stream
+// itself instead of checkUblox() parsing it byte by byte: CRC-checked RTCM frames
+// go to the framer, UBX frames are replayed into the library's parser (auto PVT,
+// HPPOSLLH, ... and their callbacks), NMEA is counted and dropped.
+static uint8_t ubxPayload[GNSS_UBX_MAX_LEN];
+// Only used for a response the library asked for, and the demultiplexer asks for none
+static ubxPacket demuxPacket = {0, 0, 0, 0, 0, ubxPayload, 0, 0, SFE_UBLOX_PACKET_VALIDITY_NOT_DEFINED,
+                                SFE_UBLOX_PACKET_VALIDITY_NOT_DEFINED};
+
+struct GnssUartHandler {
+    void rtcm(const uint8_t *data, size_t len) const {
+        ntrip_process_rtcm(data, len);
+    }
+    void ubx(const uint8_t *frame, size_t len) const {
+        for (size_t i = 0; i < len; i++) {
+            myGNSS.process(frame[i], &demuxPacket, 0, 0);
+        }
+        // Run the PVT callback now, so the GNSS clock is stamped as the frame arrives
+        myGNSS.checkCallbacks();
+    }
+    void nmea(const uint8_t *, size_t) const {}
+};
+
+typedef GnssDemux<GNSS_UBX_MAX_LEN, GNSS_NMEA_MAX_LEN, GnssUartHandler> GnssUartDemux;
+static GnssUartDemux uartDemux;
+static uint8_t uartRead[GNSS_UART_READ_SIZE];
+static uint32_t uartBytesPerSec[GnssUartDemux::PROTOCOLS];
+
+// Drain the UART through the demultiplexer, gps_uart_check_task only
+static void read_gnss_uart() {
+    int available;
+    while ((available = Serial1.available()) > 0) {
+        const size_t want = (size_t)available < sizeof(uartRead) ? available : sizeof(uartRead);
+        const size_t got = Serial1.read(uartRead, want);
+        if (got == 0) {
+            break;
+        }
+        uartDemux.process(uartRead, got);
+    }
+}
+
+// Bytes per second of each protocol, once a second
+static void update_uart_rates() {
+    static uint32_t lastBytes[GnssUartDemux::PROTOCOLS] = {};
+    static unsigned long lastUpdate_ms = 0;
+    const unsigned long now = millis();
+    const unsigned long elapsed_ms = now - lastUpdate_ms;
+    if (elapsed_ms < 1000) {
+        return;
+    }
+    const GnssUartDemux::Stats &stats = uartDemux.get_stats();
+    for (int i = 0; i < GnssUartDemux::PROTOCOLS; i++) {
+        uartBytesPerSec[i] = (uint64_t)(stats.bytes[i] - lastBytes[i]) * 1000 / elapsed_ms;
+        lastBytes[i] = stats.bytes[i];
+    }
+    lastUpdate_ms = now;
+}
+
+GnssUartStats gnss_uart_stats() {
+    const GnssUartDemux::Stats &stats = uartDemux.get_stats();
+    GnssUartStats result;
+    GnssProtocolStats *protocols[GnssUartDemux::PROTOCOLS] = {&result.rtcm, &result.ubx, &result.nmea};
+    for (int i = 0; i < GnssUartDemux::PROTOCOLS; i++) {
+        protocols[i]->bytes = stats.bytes[i];
+        protocols[i]->frames = stats.frames[i];
+        protocols[i]->bytesPerSec = uartBytesPerSec[i];
+    }
+    result.rtcmErrors = stats.rtcm_errors;
+    result.ubxErrors = stats.ubx_errors;
+    result.nmeaErrors = stats.nmea_errors;
+    result.bytesSkipped = stats.bytes_skipped;
+    return result;
+}
+
 bool initializeGPS() {
     disable_fast_uart();
     bool resp = false;
@@ -122,8 +209,8 @@ bool configureGPS() {
         error("GPS - Failed to disable NMEA.");
     }
 
-    // Enable necessary RTCM sentences
-    response &= myGNSS.enableRTCMmessage(UBX_RTCM_1005, COM_PORT_UART1, 10);
+    // Enable necessary RTCM sentences. A synthesised ARP replaces the receiver's 1005 on the UART.
+    response &= myGNSS.enableRTCMmessage(UBX_RTCM_1005, COM_PORT_UART1, arp_synth_enabled() ? 0 : 10);
     response &= myGNSS.enableRTCMmessage(UBX_RTCM_1077, COM_PORT_UART1, 1);
     response &= myGNSS.enableRTCMmessage(UBX_RTCM_1087, COM_PORT_UART1, 1);
     response &= myGNSS.enableRTCMmessage(UBX_RTCM_1097, COM_PORT_UART1, 1);
@@ -146,7 +233,7 @@ bool configureGPS() {
     response = true;
 
     response &= myGNSS.setAutoHPPOSLLH(true);
-    response &= myGNSS.setAutoPVT(true);
+    response &= myGNSS.setAutoPVTcallbackPtr(&onNavPvt);  // Also enables automatic PVT
     response &= myGNSS.setAutoNAVHPPOSECEF(true);
     response &= myGNSS.setAutoNAVSVIN(true);
 
@@ -374,9 +461,15 @@ void disable_fast_uart() {
     const int BUFFER_SIZE = 1024 * 8;  // 8KB
     const int WARNING_THRESHOLD = (BUFFER_SIZE * 75) / 100;  // 75% full
 
+    bool wasFast = false;
     for (;;) {
         // Process GNSS data if any connection is active
         if (fast_uart_handle) {
+            if (!wasFast) {
+                // The library read the UART in between, a frame in progress is gone
+                uartDemux.drop_partial();
+                wasFast = true;
+            }
             // Check buffer usage before processing
             int available = Serial1.available();
 
@@ -397,7 +490,8 @@ void disable_fast_uart() {
                 }
             }
 
-            myGNSS.checkUblox();
+            read_gnss_uart();
+            update_uart_rates();
 
             // Always use a minimal delay to allow lower-priority tasks (like loopTask) to run
             // and feed the watchdog. Even 1 tick (~1ms) is enough to prevent starvation.
@@ -410,6 +504,7 @@ void disable_fast_uart() {
                 vTaskDelay(1);  // Minimum possible delay (1 FreeRTOS tick)
             }
         } else {
+            wasFast = false;
             vTaskDelay(pdMS_TO_TICKS(10));  // 10ms delay when not in fast mode
         }
     }
@@ -3,6 +3,7 @@
 #include <Arduino.h>
 #include "utils/settings.h"
 #include <SparkFun_u-blox_GNSS_Arduino_Library.h>
+#include "network/correction_age.h"
 
 enum class GPSMode: int8_t {
   UNKNOWN = -1,
@@ -40,6 +41,27 @@ extern SFE_UBLOX_GNSS myGNSS;
 
 extern GPSStatusStruct currentGPSStatus; // Declare currentGPSStatus as an external variable
 
+extern GnssClock gnssClock; // GPS time of week from NAV-PVT, for correction ages
+
+// What the GNSS UART demultiplexer saw, per protocol
+struct GnssProtocolStats {
+  uint32_t bytes = 0;
+  uint32_t frames = 0;
+  uint32_t bytesPerSec = 0; // Over the last second
+};
+
+struct GnssUartStats {
+  GnssProtocolStats rtcm;
+  GnssProtocolStats ubx;
+  GnssProtocolStats nmea;
+  uint32_t rtcmErrors = 0;   // Bad CRC, e.g. a 0xD3 inside UBX or NMEA data
+  uint32_t ubxErrors = 0;    // Bad checksum or too long for the demultiplexer
+  uint32_t nmeaErrors = 0;
+  uint32_t bytesSkipped = 0; // Between frames or in frames with errors
+};
+
+GnssUartStats gnss_uart_stats();
+
 bool initializeGPS();
 void stopSurveyMode();
 String getSurveyStatus();
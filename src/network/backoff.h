@@ -0,0 +1,32 @@
+//
+// Reconnect backoff of one caster output.
+//
+// The delay doubles with every failed attempt from base up to cap. Half of it
+// is fixed and half is random ("equal jitter"), so casters that failed
+// together, e.g. when the uplink went down, don't all retry in the same tick.
+//
+
+#ifndef BACKOFF_H
+#define BACKOFF_H
+#include <stdint.h>
+
+namespace backoff {
+
+// Upper bound of the delay after attempts failures (attempts <= 1 gives base)
+inline uint32_t ceiling(const uint32_t base_ms, const uint32_t cap_ms, const int attempts) {
+    uint32_t delay_ms = base_ms;
+    for (int i = 1; i < attempts && delay_ms < cap_ms; i++) {
+        delay_ms *= 2;
+    }
+    return delay_ms < cap_ms ? delay_ms : cap_ms;
+}
+
+// Delay before the next attempt, random is any uniformly distributed value
+inline uint32_t delay(const uint32_t base_ms, const uint32_t cap_ms, const int attempts, const uint32_t random) {
+    const uint32_t ceiling_ms = ceiling(base_ms, cap_ms, attempts);
+    return ceiling_ms / 2 + random % (ceiling_ms / 2 + 1);
+}
+
+}
+
+#endif //BACKOFF_H
@@ -0,0 +1,52 @@
+//
+// In-place HTTP chunk framing (NTRIP 2.0) around an RTCM frame.
+//
+// The frame is stored with CHUNK_HEADROOM spare bytes in front of it and
+// CHUNK_TAILROOM behind it. encode_chunk() writes the "<hex size>\r\n" header
+// right-aligned into the headroom and the "\r\n" trailer behind the frame, once
+// per frame. NTRIP 2.0 outputs then send the chunk view and NTRIP 1.0 outputs
+// the raw frame, both straight from the same buffer.
+//
+
+#ifndef CHUNK_FRAME_H
+#define CHUNK_FRAME_H
+#include <stdint.h>
+#include <stddef.h>
+
+namespace chunk_frame {
+
+// "405\r\n" for the largest RTCM frame (1029 bytes)
+constexpr size_t CHUNK_HEADROOM = 5;
+constexpr size_t CHUNK_TAILROOM = 2;
+
+inline size_t header_len(const size_t frame_len) {
+    return (frame_len >= 0x100 ? 3 : frame_len >= 0x10 ? 2 : 1) + 2;
+}
+
+// frame points CHUNK_HEADROOM bytes into its buffer, frame_len < 0x1000
+inline void encode_chunk(uint8_t *frame, const size_t frame_len) {
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t *p = frame - 2;
+    p[0] = '\r';
+    p[1] = '\n';
+    size_t value = frame_len;
+    do {
+        *--p = hex[value & 0x0F];
+        value >>= 4;
+    } while (value != 0);
+    frame[frame_len] = '\r';
+    frame[frame_len + 1] = '\n';
+}
+
+// Start and length of the complete chunk around an encoded frame
+inline const uint8_t *chunk_start(const uint8_t *frame, const size_t frame_len) {
+    return frame - header_len(frame_len);
+}
+
+inline size_t chunk_len(const size_t frame_len) {
+    return header_len(frame_len) + frame_len + CHUNK_TAILROOM;
+}
+
+}
+
+#endif //CHUNK_FRAME_H
@@ -0,0 +1,106 @@
+#include "correction_age.h"
+#include <string.h>
+#include "msm.h"
+
+void GnssClock::set(const uint32_t tow, const uint32_t local_ms) {
+    sequence++;
+    tow_ms = tow % msm::WEEK_MS;
+    set_ms = local_ms;
+    sequence++;
+}
+
+bool GnssClock::time_of_week(const uint32_t local_ms, uint32_t &tow) const {
+    uint32_t before;
+    uint32_t reference_ms;
+    uint32_t stamp_ms;
+    do {
+        before = sequence;
+        reference_ms = tow_ms;
+        stamp_ms = set_ms;
+    } while ((before & 1) || sequence != before);
+    // Unsigned differences, so the local ms counter may wrap in between
+    if (before == 0 || local_ms - stamp_ms > STALE_MS) {
+        return false;
+    }
+    tow = (reference_ms + (local_ms - stamp_ms)) % msm::WEEK_MS;
+    return true;
+}
+
+bool correction_age_ms(const GnssClock &clock, const uint8_t *frame, const int len, const uint32_t local_ms,
+                       uint32_t &age_ms) {
+    msm::Header header;
+    uint32_t epoch_ms;
+    uint32_t now_ms;
+    if (len < 6 || !msm::decode_header(frame + 3, len - 6, header) || !msm::gps_time_of_week(header, epoch_ms) ||
+        !clock.time_of_week(local_ms, now_ms)) {
+        return false;
+    }
+    age_ms = (now_ms + msm::WEEK_MS - epoch_ms) % msm::WEEK_MS;
+    if (age_ms > msm::WEEK_MS / 2) {
+        age_ms = 0;  // Epoch time ahead of the clock
+    }
+    return true;
+}
+
+void AgeHistogram::clear() {
+    memset(buckets, 0, sizeof(buckets));
+    count = 0;
+    maxAge_ms = 0;
+}
+
+int AgeHistogram::bucket(uint32_t age_ms) {
+    if (age_ms > MAX_AGE_MS) {
+        age_ms = MAX_AGE_MS;
+    }
+    if (age_ms < SUB_BUCKETS) {
+        return age_ms;
+    }
+    // [2^p, 2^(p+1)) split into 8, p >= 3
+    const int power = 31 - __builtin_clz(age_ms);
+    return (power - 2) * SUB_BUCKETS + ((age_ms >> (power - 3)) & (SUB_BUCKETS - 1));
+}
+
+uint32_t AgeHistogram::bucket_upper(const int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const int shift = index / SUB_BUCKETS - 1;
+    const uint32_t lower = (uint32_t)(SUB_BUCKETS + index % SUB_BUCKETS) << shift;
+    return lower + (1u << shift) - 1;
+}
+
+void AgeHistogram::record(const uint32_t age_ms) {
+    buckets[bucket(age_ms)]++;
+    count++;
+    if (age_ms > maxAge_ms) {
+        maxAge_ms = age_ms;
+    }
+}
+
+uint32_t AgeHistogram::percentile(const int percent) const {
+    const uint32_t total = count;
+    if (total == 0) {
+        return 0;
+    }
+    // Rank of the sample, rounded up: p50 of 3 samples is the 2nd
+    const uint32_t rank = ((uint64_t)total * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0) {
+            const uint32_t upper = bucket_upper(i);
+            return upper < maxAge_ms ? upper : maxAge_ms;
+        }
+    }
+    return maxAge_ms;
+}
+
+AgeSummary AgeHistogram::summary() const {
+    AgeSummary summary;
+    summary.p50_ms = percentile(50);
+    summary.p95_ms = percentile(95);
+    summary.p99_ms = percentile(99);
+    summary.max_ms = maxAge_ms;
+    summary.samples = count;
+    return summary;
+}
@@ -0,0 +1,84 @@
+//
+// Correction age: how old an MSM epoch is, in GNSS time, when it reaches a
+// given point of the pipeline.
+//
+// The receiver's NAV-PVT gives a GPS time of week for a local millis() stamp
+// (GnssClock). The age of an MSM frame is that clock's current time of week
+// minus the frame's epoch time. The PVT of an epoch leaves the receiver about
+// as late as its MSMs, so the receiver's own output delay is not part of the
+// age: it covers the UART, the tasks in between and, at send time, the
+// queue and the socket write.
+//
+// Ages go into a log-linear histogram (8 buckets per power of two, within
+// 12.5%) so percentiles cost no memory per sample.
+//
+
+#ifndef CORRECTION_AGE_H
+#define CORRECTION_AGE_H
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// GPS time of week from the latest PVT, written by the GNSS UART task only and
+// read by any task. A sequence counter keeps readers from mixing the time of
+// week of one update with the stamp of another.
+class GnssClock {
+public:
+    // The reference is dropped when no PVT came for this long
+    static constexpr uint32_t STALE_MS = 5000;
+
+    GnssClock() : sequence(0), tow_ms(0), set_ms(0) {}
+
+    // Time of week tow (ms) was current at local_ms
+    void set(uint32_t tow, uint32_t local_ms);
+    // GPS time of week at local_ms, false without a recent reference
+    bool time_of_week(uint32_t local_ms, uint32_t &tow) const;
+
+private:
+    std::atomic<uint32_t> sequence;  // Odd while set() runs, 0 before the first
+    std::atomic<uint32_t> tow_ms;
+    std::atomic<uint32_t> set_ms;
+};
+
+// Age in ms of the MSM frame (complete, with header and CRC) at local_ms.
+// False for anything but MSM, for GLONASS MSM and without a clock reference.
+// A frame that looks younger than 0 (it arrived before the PVT of its epoch) is 0 ms old.
+bool correction_age_ms(const GnssClock &clock, const uint8_t *frame, int len, uint32_t local_ms, uint32_t &age_ms);
+
+// Percentiles of a histogram, in ms (upper bound of the bucket, at most max_ms)
+struct AgeSummary {
+    uint32_t p50_ms;
+    uint32_t p95_ms;
+    uint32_t p99_ms;
+    uint32_t max_ms;
+    uint32_t samples;
+};
+
+// One task records, other tasks may read while it does
+class AgeHistogram {
+public:
+    static constexpr int SUB_BUCKETS = 8;
+    static constexpr uint32_t MAX_AGE_MS = 65535;  // Longer ages count as this
+    static constexpr int BUCKETS = 112;            // Index of MAX_AGE_MS + 1
+
+    AgeHistogram() { clear(); }
+
+    void clear();
+    void record(uint32_t age_ms);
+
+    // Age at or below which percent of the samples are, 0 without samples
+    uint32_t percentile(int percent) const;
+    uint32_t max_ms() const { return maxAge_ms; }
+    uint32_t samples() const { return count; }
+    AgeSummary summary() const;
+
+    static int bucket(uint32_t age_ms);
+    static uint32_t bucket_upper(int index);
+
+private:
+    uint32_t buckets[BUCKETS];
+    uint32_t count;
+    uint32_t maxAge_ms;
+};
+
+#endif //CORRECTION_AGE_H
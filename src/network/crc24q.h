@@ -0,0 +1,126 @@
+//
+// CRC24Q (RTCM 3.x frame check, polynomial 0x1864CFB) with compile-time tables.
+//
+// Tables are generated by the compiler (constexpr) and live in flash, so no
+// runtime init is needed before the first frame. Table k holds the CRC of a
+// single byte followed by k zero bytes, which lets the block variants fold 4 or
+// 8 input bytes per step ("slicing-by-N") instead of one table lookup per byte.
+//
+// Written for C++11 (gnu++11 on the ESP32 Arduino core), hence the recursive
+// constexpr helpers instead of loops.
+//
+
+#ifndef CRC24Q_H
+#define CRC24Q_H
+#include <stdint.h>
+#include <stddef.h>
+
+namespace crc24q {
+
+constexpr uint32_t POLY = 0x1864CFB;
+constexpr int SLICES = 8;
+
+// ----- Compile-time table generation -----
+
+constexpr uint32_t shift_bit(uint32_t crc) {
+    return (crc & 0x800000) ? ((crc << 1) ^ POLY) & 0xFFFFFF : (crc << 1) & 0xFFFFFF;
+}
+
+constexpr uint32_t shift_bits(uint32_t crc, int bits) {
+    return bits == 0 ? crc : shift_bits(shift_bit(crc), bits - 1);
+}
+
+// CRC of a single byte from a zero register (the classic bytewise table)
+constexpr uint32_t byte_entry(uint32_t value) {
+    return shift_bits(value << 16, 8);
+}
+
+// Run one zero byte through the register
+constexpr uint32_t zero_byte(uint32_t crc) {
+    return ((crc << 8) & 0xFFFFFF) ^ byte_entry(crc >> 16);
+}
+
+// CRC of `value` followed by `zeros` zero bytes
+constexpr uint32_t slice_entry(int zeros, uint32_t value) {
+    return zeros == 0 ? byte_entry(value) : zero_byte(slice_entry(zeros - 1, value));
+}
+
+template <size_t... I> struct index_seq {};
+template <size_t N, size_t... I> struct make_index_seq : make_index_seq<N - 1, N - 1, I...> {};
+template <size_t... I> struct make_index_seq<0, I...> { typedef index_seq<I...> type; };
+
+struct Table {
+    uint32_t v[256];
+};
+
+template <size_t... I>
+constexpr Table make_table(int zeros, index_seq<I...>) {
+    return Table{{slice_entry(zeros, I)...}};
+}
+
+constexpr Table make_table(int zeros) {
+    return make_table(zeros, make_index_seq<256>::type());
+}
+
+// Class template so the constexpr array can be defined in this header
+// (C++11 has no inline variables).
+template <typename Unused = void>
+struct Tables {
+    static constexpr Table t[SLICES] = {
+        make_table(0), make_table(1), make_table(2), make_table(3),
+        make_table(4), make_table(5), make_table(6), make_table(7),
+    };
+};
+template <typename Unused>
+constexpr Table Tables<Unused>::t[SLICES];
+
+static_assert(Tables<>::t[0].v[1] == 0x864CFB, "CRC24Q table must be generated at compile time");
+
+// ----- Runtime kernels -----
+
+// Bytewise update, used by the streaming state machine (one byte at a time)
+inline uint32_t update(uint32_t crc, uint8_t byte) {
+    return ((crc << 8) & 0xFFFFFF) ^ Tables<>::t[0].v[((crc >> 16) ^ byte) & 0xFF];
+}
+
+inline uint32_t update(uint32_t crc, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc = update(crc, *data++);
+    }
+    return crc;
+}
+
+// Slicing-by-4: the 24-bit register is folded into the first 3 bytes of each
+// group, the 4th byte goes through table 0.
+inline uint32_t update_sliced4(uint32_t crc, const uint8_t *data, size_t len) {
+    const Table *t = Tables<>::t;
+    while (len >= 4) {
+        const uint32_t x = crc ^ ((uint32_t)data[0] << 16 | (uint32_t)data[1] << 8 | data[2]);
+        crc = t[3].v[x >> 16] ^ t[2].v[(x >> 8) & 0xFF] ^ t[1].v[x & 0xFF] ^ t[0].v[data[3]];
+        data += 4;
+        len -= 4;
+    }
+    return update(crc, data, len);
+}
+
+// Slicing-by-8: same as above with 5 plain bytes per group
+inline uint32_t update_sliced8(uint32_t crc, const uint8_t *data, size_t len) {
+    const Table *t = Tables<>::t;
+    while (len >= 8) {
+        const uint32_t x = crc ^ ((uint32_t)data[0] << 16 | (uint32_t)data[1] << 8 | data[2]);
+        crc = t[7].v[x >> 16] ^ t[6].v[(x >> 8) & 0xFF] ^ t[5].v[x & 0xFF] ^
+              t[4].v[data[3]] ^ t[3].v[data[4]] ^ t[2].v[data[5]] ^ t[1].v[data[6]] ^ t[0].v[data[7]];
+        data += 8;
+        len -= 8;
+    }
+    return update(crc, data, len);
+}
+
+// CRC24Q of a complete block (e.g. RTCM header + payload)
+inline uint32_t compute(const uint8_t *data, size_t len) {
+    return update_sliced8(0, data, len);
+}
+
+}
+
+#endif //CRC24Q_H
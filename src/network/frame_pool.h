@@ -0,0 +1,112 @@
+//
+// Fixed-slot, reference-counted frame pool.
+//
+// Frames are assembled directly in a slot by the producer (the RTCM framer) and
+// then handed to any number of consumers by pointer. Each consumer releases its
+// reference when done; the slot becomes free again when the count drops to zero.
+// All storage is allocated up front by begin(), at most MaxSlots slots, so the
+// pool only takes the RAM the configured outputs need. Nothing is copied per
+// consumer.
+//
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <new>
+
+template <size_t MaxSlots, size_t SlotSize>
+class FramePool {
+    static_assert(MaxSlots > 0 && MaxSlots < 256, "MaxSlots must fit the 8-bit slot index");
+
+public:
+    struct Slot {
+        std::atomic<uint8_t> refs;  // 0 = free
+        uint16_t len;
+        uint8_t data[SlotSize];
+    };
+
+    FramePool() : slot_count(0), next_hint(0), exhausted(0) {}
+
+    ~FramePool() {
+        for (size_t i = 0; i < slot_count; i++) {
+            delete slots[i];
+        }
+    }
+
+    // Allocate count slots (at most MaxSlots), once before the first acquire(). Each slot is
+    // a separate allocation, so no single block of the whole pool is needed. Returns the
+    // number of slots allocated, fewer than count when the heap ran out.
+    size_t begin(size_t count) {
+        if (count > MaxSlots) {
+            count = MaxSlots;
+        }
+        while (slot_count < count) {
+            Slot *slot = new (std::nothrow) Slot;
+            if (slot == nullptr) {
+                break;
+            }
+            slot->refs.store(0);
+            slot->len = 0;
+            slots[slot_count++] = slot;
+        }
+        return slot_count;
+    }
+
+    // Claim a free slot for writing. The caller holds the only reference.
+    // Returns nullptr when every slot is still referenced by a consumer.
+    Slot *acquire() {
+        for (size_t n = 0; n < slot_count; n++) {
+            const size_t i = (next_hint + n) % slot_count;
+            uint8_t expected = 0;
+            if (slots[i]->refs.compare_exchange_strong(expected, 1)) {
+                next_hint = (i + 1) % slot_count;
+                return slots[i];
+            }
+        }
+        exhausted++;
+        return nullptr;
+    }
+
+    static void retain(Slot *slot) {
+        slot->refs.fetch_add(1);
+    }
+
+    static void release(Slot *slot) {
+        slot->refs.fetch_sub(1);
+    }
+
+    // Snapshot of slots currently referenced (writer or consumers)
+    size_t in_use() const {
+        size_t count = 0;
+        for (size_t i = 0; i < slot_count; i++) {
+            if (slots[i]->refs.load() != 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Number of failed acquire() calls
+    uint32_t exhausted_count() const {
+        return exhausted;
+    }
+
+    // Slots allocated by begin()
+    size_t capacity() const {
+        return slot_count;
+    }
+
+    static constexpr size_t max_capacity() {
+        return MaxSlots;
+    }
+
+private:
+    Slot *slots[MaxSlots];
+    size_t slot_count;
+    size_t next_hint;  // Round-robin start for acquire(), producer only
+    uint32_t exhausted;
+};
+
+#endif //FRAME_POOL_H
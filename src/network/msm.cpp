@@ -0,0 +1,227 @@
+#include "msm.h"
+#include <string.h>
+#include "rtcmbuffer.h"
+#include "rtcm_encoder.h"
+
+namespace msm {
+
+uint32_t get_bits(const uint8_t *data, size_t pos, int bits) {
+    uint32_t value = 0;
+    while (bits > 0) {
+        const int available = 8 - (pos & 7);
+        const int take = bits < available ? bits : available;
+        value = (value << take) | ((data[pos >> 3] >> (available - take)) & ((1u << take) - 1));
+        pos += take;
+        bits -= take;
+    }
+    return value;
+}
+
+int32_t get_signed(const uint8_t *data, const size_t pos, const int bits) {
+    uint32_t value = get_bits(data, pos, bits);
+    if (bits < 32 && (value & (1u << (bits - 1)))) {
+        value |= ~0u << bits;
+    }
+    return (int32_t)value;
+}
+
+static int count_bits(const uint32_t value) {
+    return __builtin_popcount(value);
+}
+
+// Bits per satellite and per cell of the data blocks, by MSM number
+static const uint8_t SAT_BITS[8] = {0, 10, 10, 10, 18, 36, 18, 36};
+static const uint8_t CELL_BITS[8] = {0, 15, 27, 42, 48, 63, 65, 80};
+
+bool decode_header(const uint8_t *payload, const size_t payload_len, Header &header) {
+    if (payload_len * 8 < HEADER_BITS) {
+        return false;
+    }
+    header.msg_type = rtcmbuffer::get_rtcm_message_type(payload);
+    if (!rtcmbuffer::is_msm(header.msg_type)) {
+        return false;
+    }
+    header.station_id = get_bits(payload, 12, 12);
+    header.epoch_time = get_bits(payload, 24, 30);
+    header.multiple_message = get_bits(payload, 54, 1);
+    // Satellite mask at bit 73, signal mask at bit 137
+    header.sats = count_bits(get_bits(payload, 73, 32)) + count_bits(get_bits(payload, 105, 32));
+    header.signals = count_bits(get_bits(payload, 137, 32));
+    const int maskBits = header.sats * header.signals;
+    if (maskBits > MAX_CELLS || payload_len * 8 < HEADER_BITS + maskBits) {
+        return false;
+    }
+
+    header.cells = 0;
+    for (int bit = 0; bit < maskBits; bit += 32) {
+        const int width = maskBits - bit < 32 ? maskBits - bit : 32;
+        header.cells += count_bits(get_bits(payload, HEADER_BITS + bit, width));
+    }
+    return true;
+}
+
+bool parse_layout(const uint8_t *payload, const size_t payload_len, Layout &layout) {
+    Header header;
+    if (!decode_header(payload, payload_len, header)) {
+        return false;
+    }
+    layout.msg_type = header.msg_type;
+    layout.sats = header.sats;
+    layout.signals = header.signals;
+    layout.cells = header.cells;
+    const int msm_number = layout.msg_type % 10;
+    layout.sat_data_pos = HEADER_BITS + header.sats * header.signals;
+    layout.cell_data_pos = layout.sat_data_pos + layout.sats * SAT_BITS[msm_number];
+    layout.payload_bits = layout.cell_data_pos + layout.cells * CELL_BITS[msm_number];
+    return payload_len * 8 >= layout.payload_bits;
+}
+
+const char *constellation_name(const int index) {
+    static const char *const names[CONSTELLATIONS] = {"GPS", "GLONASS", "Galileo", "SBAS", "QZSS", "BeiDou", "NavIC"};
+    return index >= 0 && index < CONSTELLATIONS ? names[index] : "";
+}
+
+bool gps_time_of_week(const Header &header, uint32_t &tow_ms) {
+    static const int GLONASS = 1;
+    static const int BEIDOU = 5;
+    static const uint32_t BDT_OFFSET_MS = 14000;
+    const int constellation = constellation_index(header.msg_type);
+    if (constellation == GLONASS || header.epoch_time >= WEEK_MS) {
+        return false;
+    }
+    tow_ms = header.epoch_time;
+    if (constellation == BEIDOU) {
+        tow_ms = (tow_ms + BDT_OFFSET_MS) % WEEK_MS;
+    }
+    return true;
+}
+
+void StreamStats::add(const uint8_t *frame, const int len) {
+    Header header;
+    if (len < 6 || !decode_header(frame + 3, len - 6, header)) {
+        return;
+    }
+    ConstellationStats &constellation = stats[constellation_index(header.msg_type)];
+    const uint8_t bit = 1 << constellation_index(header.msg_type);
+    if ((inEpoch & bit) && header.epoch_time != constellation.epoch_time) {
+        // Next epoch already, the last frame of the previous one never came
+        incompleteEpochs++;
+        inEpoch = 0;
+    }
+    if (!(inEpoch & bit)) {
+        inEpoch |= bit;
+        constellation.epoch_time = header.epoch_time;
+        constellation.sats = 0;
+        constellation.cells = 0;
+        constellation.epochs++;
+    }
+    // More frames of one constellation and epoch add up
+    constellation.msg_type = header.msg_type;
+    constellation.sats += header.sats;
+    constellation.signals = header.signals;
+    constellation.cells += header.cells;
+    constellation.frames++;
+
+    if (!header.multiple_message) {
+        epochs++;
+        lastEpochConstellations = __builtin_popcount(inEpoch);
+        inEpoch = 0;
+    }
+}
+
+uint8_t lock_time_indicator(uint32_t extended) {
+    // DF407 counts ms up to 63, then each block of 32 values doubles the step:
+    // block k (from 64 + 32(k-1)) covers lock times [2^(k+5), 2^(k+6)).
+    // DF402 1..15 stands for at least 2^(n+4) ms, 0 for under 32 ms.
+    if (extended < 32) {
+        return 0;
+    }
+    if (extended < 64) {
+        return 1;
+    }
+    if (extended > 704) {
+        extended = 704;  // Reserved values, keep the longest lock time
+    }
+    const uint32_t indicator = (extended - 64) / 32 + 2;
+    return indicator > 15 ? 15 : indicator;
+}
+
+// Drop shift bits with rounding, clamped to +-limit. The invalid marker (the
+// most negative value) maps to the narrower field's invalid marker.
+static int32_t reduce(const int32_t value, const int bits, const int shift, const int out_bits) {
+    const int32_t invalid = -(int32_t)(1u << (bits - 1));
+    const int32_t limit = (int32_t)(1u << (out_bits - 1)) - 1;
+    if (value == invalid) {
+        return -limit - 1;
+    }
+    // Arithmetic shift: rounds half up for negative values too
+    const int32_t rounded = (value + (1 << (shift - 1))) >> shift;
+    return rounded > limit ? limit : (rounded < -limit ? -limit : rounded);
+}
+
+size_t msm7_to_msm4(const uint8_t *frame, const int len, uint8_t *out) {
+    if (len < 6) {
+        return 0;
+    }
+    const uint8_t *payload = frame + 3;
+    const size_t payload_len = rtcmbuffer::parse_rtcm_length(frame);
+    Layout layout;
+    if ((size_t)len < payload_len + 6 || !parse_layout(payload, payload_len, layout) || layout.msg_type % 10 != 7) {
+        return 0;
+    }
+
+    const int sats = layout.sats;
+    const int cells = layout.cells;
+    const size_t payload_bits = layout.sat_data_pos + sats * SAT_BITS[4] + cells * CELL_BITS[4];
+    memset(out, 0, 3 + (payload_bits + 7) / 8);
+    rtcm_encoder::BitWriter bits(out + 3);
+
+    // Header and masks unchanged apart from the message number
+    bits.put(layout.msg_type - 3, 12);
+    size_t pos = 12;
+    while (pos < layout.sat_data_pos) {
+        const int chunk = layout.sat_data_pos - pos < 32 ? layout.sat_data_pos - pos : 32;
+        bits.put(get_bits(payload, pos, chunk), chunk);
+        pos += chunk;
+    }
+
+    // Satellite data: DF397 (8) and DF398 (10) kept, the extended info and DF399 rough rate dropped
+    const size_t rough_ms = layout.sat_data_pos;
+    const size_t rough_mod = rough_ms + sats * (8 + 4);
+    for (int i = 0; i < sats; i++) {
+        bits.put(get_bits(payload, rough_ms + i * 8, 8), 8);
+    }
+    for (int i = 0; i < sats; i++) {
+        bits.put(get_bits(payload, rough_mod + i * 10, 10), 10);
+    }
+
+    // Signal data. MSM7 arrays: DF405 (20), DF406 (24), DF407 (10), DF420 (1), DF408 (10), DF404 (15)
+    const size_t pseudorange = layout.cell_data_pos;
+    const size_t phaserange = pseudorange + cells * 20;
+    const size_t lock_time = phaserange + cells * 24;
+    const size_t half_cycle = lock_time + cells * 10;
+    const size_t cnr = half_cycle + cells * 1;
+    for (int i = 0; i < cells; i++) {
+        // DF405 2^-29 ms -> DF400 2^-24 ms, same range
+        bits.put_signed(reduce(get_signed(payload, pseudorange + i * 20, 20), 20, 5, 15), 15);
+    }
+    for (int i = 0; i < cells; i++) {
+        // DF406 2^-31 ms -> DF401 2^-29 ms, same range
+        bits.put_signed(reduce(get_signed(payload, phaserange + i * 24, 24), 24, 2, 22), 22);
+    }
+    for (int i = 0; i < cells; i++) {
+        bits.put(lock_time_indicator(get_bits(payload, lock_time + i * 10, 10)), 4);
+    }
+    for (int i = 0; i < cells; i++) {
+        bits.put(get_bits(payload, half_cycle + i, 1), 1);
+    }
+    for (int i = 0; i < cells; i++) {
+        // DF408 2^-4 dB-Hz -> DF403 1 dB-Hz, 0 stays "not computed"
+        const uint32_t cnr4 = (get_bits(payload, cnr + i * 10, 10) + 8) >> 4;
+        bits.put(cnr4 > 63 ? 63 : cnr4, 6);
+    }
+
+    return rtcm_encoder::finish_frame(out, (bits.bits_written() + 7) / 8);
+}
+
+}
@@ -0,0 +1,120 @@
+//
+// Bit-level access to RTCM 3 MSM frames (10x1-10x7) and the MSM7 -> MSM4
+// re-encoder for bandwidth-constrained outputs.
+//
+// MSM payload layout (RTCM 10403.3, 3.5.12.3):
+//   header      169 bits up to the signal mask, then the cell mask (Nsat x Nsig bits)
+//   satellite   one array per field, Nsat entries each
+//   signal      one array per field, Ncell entries each
+// Because each field is an array, any field of any cell can be read straight
+// from the frame by bit offset without decoding the rest.
+//
+
+#ifndef MSM_H
+#define MSM_H
+#include <stdint.h>
+#include <stddef.h>
+
+namespace msm {
+
+// Header bits before the cell mask
+constexpr size_t HEADER_BITS = 169;
+// The cell mask is at most 64 bits (DF396)
+constexpr int MAX_CELLS = 64;
+
+// Read an unsigned / two's complement field, 1-32 bits wide, MSB first
+uint32_t get_bits(const uint8_t *data, size_t pos, int bits);
+int32_t get_signed(const uint8_t *data, size_t pos, int bits);
+
+// The MSM header fields the firmware looks at, the observables stay undecoded
+struct Header {
+    int msg_type;
+    uint16_t station_id;    // DF003
+    uint32_t epoch_time;    // 30 bits, GNSS specific: ms of week, GLONASS day of week + ms of day
+    bool multiple_message;  // DF393, clear on the last MSM of an epoch
+    int sats;               // Satellites in the satellite mask
+    int signals;            // Signals in the signal mask
+    int cells;              // Set bits in the cell mask
+};
+
+// Decode the header and masks of an MSM payload, nothing after the cell mask.
+// False if it isn't an MSM, the cell mask is too large or the payload ends
+// inside the header. A few loads and popcounts, cheap enough for every frame.
+bool decode_header(const uint8_t *payload, size_t payload_len, Header &header);
+
+// Where the variable-size parts of one MSM payload start
+struct Layout {
+    int msg_type;
+    int sats;
+    int signals;
+    int cells;
+    size_t sat_data_pos;   // Bit offset of the satellite data
+    size_t cell_data_pos;  // Bit offset of the signal data
+    size_t payload_bits;   // Total, before the padding to a whole byte
+};
+
+// Read the masks of an MSM payload. False if it isn't an MSM, the cell mask
+// is too large or payload_len is too short for the data the masks announce.
+bool parse_layout(const uint8_t *payload, size_t payload_len, Layout &layout);
+
+// MSM constellations in message number order: GPS 107x, GLONASS 108x, Galileo
+// 109x, SBAS 110x, QZSS 111x, BeiDou 112x, NavIC 113x
+constexpr int CONSTELLATIONS = 7;
+inline int constellation_index(const int msg_type) { return msg_type / 10 - 107; }
+const char *constellation_name(int index);
+
+constexpr uint32_t WEEK_MS = 604800000;
+// The epoch time of a header as GPS time of week in ms. GPS, Galileo, SBAS,
+// QZSS and NavIC count GPS time of week already, BeiDou time is 14 s behind.
+// False for GLONASS, its day and time of day in UTC(SU) would need the leap seconds.
+bool gps_time_of_week(const Header &header, uint32_t &tow_ms);
+
+// What the MSM headers of a stream say, per constellation and per epoch
+struct ConstellationStats {
+    int msg_type;         // Latest MSM number seen, 0 if none
+    uint32_t epoch_time;  // Of the latest epoch
+    uint8_t sats;         // In the latest epoch, summed over its frames
+    uint8_t signals;
+    uint16_t cells;
+    uint32_t frames;
+    uint32_t epochs;      // Epochs the constellation was part of
+};
+
+// Runs on every frame in the GNSS UART task, other tasks only read the counters.
+// An epoch is complete when its last MSM (multiple message bit clear) arrives;
+// a constellation starting a new epoch time before that counts as incomplete.
+class StreamStats {
+public:
+    StreamStats() : stats(), epochs(0), incompleteEpochs(0), lastEpochConstellations(0), inEpoch(0) {}
+
+    // Account one CRC-checked frame, anything but MSM is ignored
+    void add(const uint8_t *frame, int len);
+
+    const ConstellationStats &constellation(const int index) const { return stats[index]; }
+    uint32_t complete_epochs() const { return epochs; }
+    uint32_t incomplete_epochs() const { return incompleteEpochs; }
+    // Constellations in the latest complete epoch
+    int constellations_per_epoch() const { return lastEpochConstellations; }
+
+private:
+    ConstellationStats stats[CONSTELLATIONS];
+    uint32_t epochs;
+    uint32_t incompleteEpochs;
+    int lastEpochConstellations;
+    uint8_t inEpoch;  // Bit per constellation seen since the last epoch end
+};
+
+// DF407 extended lock time indicator to the DF402 indicator for the same lock time
+uint8_t lock_time_indicator(uint32_t extended);
+
+// Re-encode an MSM7 frame (10x7) as the MSM4 (10x4) of the same constellation:
+// same header, masks and multiple message bit, pseudorange, phaserange and
+// CNR at MSM4 resolution, lock time converted, rough and fine phaserange
+// rates dropped. out must hold len bytes, the result is always shorter.
+// Returns the new frame length, or 0 if frame isn't a well-formed MSM7.
+// Uses no buffers besides out.
+size_t msm7_to_msm4(const uint8_t *frame, int len, uint8_t *out);
+
+}
+
+#endif //MSM_H
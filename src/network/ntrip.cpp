@@ -1,10 +1,23 @@
 #include <core/defines.h>
 #include <Arduino.h>
+#include <atomic>
 #include "ntrip.h"
 #include "hardware/gps.h"
 #include <WebServer_ESP32_SC_W6100.hpp>
 #include "utils/log.h"
+#include "utils/settings.h"
 #include "rtcmbuffer.h"
+#include "rtcm_output.h"
+#include "spsc_ring.h"
+#include "backoff.h"
+#include "rtcm_inject.h"
+#include "rtcm_filter.h"
+#include "msm.h"
+#include "correction_age.h"
+#include "rtcm_server.h"
+#include "rtcm_udp.h"
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
 
 // Base64 encoding table
 const char base64_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -56,50 +69,138 @@ String base64_encode(const String& input) {
     return result;
 }
 
-// Primary connection
-WiFiClient client;
-// Secondary connection
-WiFiClient client2;
-
 // Configuration
 constexpr int connectionTimeout      = NTRIP_CONNECTION_TIMEOUT_MS;  // MS threshold for timeout when connecting
 constexpr int maxTimeBeforeHangup_ms = NTRIP_RTCM_TIMEOUT_MS;        // Disconnect after timeout without data
-constexpr int reconnectDelay         = NTRIP_RECONNECT_DELAY_MS;     // Delay between reconnection attempts
-constexpr int slowReconnectDelay     = 30000;                        // Slower delay after 5 failed attempts
-constexpr int maxReconnectAttempts   = 5;                            // Maximum number of attempts before using slow delay
+constexpr int reconnectDelay         = NTRIP_RECONNECT_DELAY_MS;     // Backoff after the first failed attempt, doubles per failure
+constexpr int maxReconnectDelay      = NTRIP_MAX_RECONNECT_DELAY_MS; // Backoff cap
 constexpr int rtcmCheckInterval_ms   = 1000;                         // Check for RTCM data every second
 constexpr int connectionStabilityTimeout_ms = NTRIP_STABILITY_TIMEOUT_MS;  // Time to wait before considering connection stable
+constexpr int idleWakeInterval_ms    = 100;                          // Run connection upkeep at least this often without RTCM
+constexpr int handshakePollInterval_ms = 5;                          // Tick rate while a connect/handshake is in progress
+constexpr unsigned long maxFrameAge_us = CASTER_MAX_FRAME_AGE_MS * 1000UL; // Queued frames older than this are discarded
+constexpr unsigned long epochDeadline_us = CASTER_EPOCH_DEADLINE_MS * 1000UL; // Send a coalesced epoch at the latest after this
+constexpr int tcpMss                 = 1436;                         // lwIP TCP_MSS, for the segments/epoch estimate
+unsigned long writeStallTimeout_ms   = NTRIP_WRITE_STALL_MS;         // Setting stallTimeout, a write blocked this long marks the connection dead
 
 // Status tracking
-NTRIPStatus NtripPrimaryStatus   = {false, 0,  "", 0, 0, 1};  // Default to NTRIP 1.0
-NTRIPStatus NtripSecondaryStatus = {false, 0,  "", 0, 0, 1};  // Default to NTRIP 1.0
-unsigned long lastReport_ms      = 0;
 unsigned long lastRtcmData_ms    = 0;  // Track when we last received RTCM data
-unsigned long lastHealthCheck_ms = 0;  // Rate limit health checks
-
-// Mutex for thread-safe status access
-SemaphoreHandle_t statusMutex = NULL;
 
 bool ntrip_inited = false;
 
-[[noreturn]] void NTRIPTask(void *pvParameter);
-
-bool checkAndConnect(WiFiClient& client, NTRIPStatus& status, const bool isPrimary);
+// The GNSS UART task only enqueues; each caster task is woken by a task
+// notification, drains its own ring and does its own socket I/O.
+typedef SpscRing<QueuedFrame, CASTER_QUEUE_DEPTH> CasterQueue;
+
+// Station metadata sent to a caster right after its handshake, ahead of the
+// live stream, so rovers don't wait for the next low-rate 1005/1033/1230 on the
+// UART before they can fix. The latest frame of each type keeps its pool slot.
+constexpr int stationMessageTypes[] = {1005, 1006, 1033, 1230};
+constexpr int stationFrameTypes = sizeof(stationMessageTypes) / sizeof(stationMessageTypes[0]);
+
+// A caster holds at most CASTER_MAX_HELD_FRAMES slots (see queueToCaster), enough for a full
+// coalesced epoch. The station cache holds one per type, each injected message one for good.
+static_assert(frame_pool_budget::CASTER >= CASTER_EPOCH_MAX_FRAMES, "A caster must be able to hold a coalesced epoch");
+static_assert(frame_pool_budget::STATION_CACHE >= stationFrameTypes, "Frame pool share of the station cache too small");
+static_assert(frame_pool_budget::INJECTED >= (int)InjectedMessage::COUNT, "Frame pool share of injected messages too small");
+static_assert(RTCM_FRAME_POOL_SLOTS >= frame_pool_budget::TOTAL, "Frame pool smaller than the shares of all holders");
+
+// One upstream caster output slot (settings keys "<name><number>") with its own
+// connection, frame queue and sender task, so a stalled or reconnecting caster
+// only delays its own frames. See NTRIP_CASTER_COUNT for the cost per slot.
+//
+// Backpressure: a full queue drops the newest frame (counted by the ring), and
+// frames that waited longer than maxFrameAge_us are discarded unsent because
+// rovers can't use stale corrections anyway. A caster that already holds
+// CASTER_MAX_HELD_FRAMES pool slots (queued plus coalescing) gets no more until
+// it releases some, so a stalled caster never starves the shared frame pool.
+//
+// With coalescing on (setting coalesce<n>), frames are held until the MSM
+// multiple message bit marks the end of the epoch or epochDeadline_us passes,
+// then the whole epoch goes out as one gather write instead of one write per
+// frame.
+//
+// Connecting never blocks the task: each tick advances the state machine
+//   IDLE -> CONNECTING (non-blocking TCP connect) -> REQUEST_SENT (reading the
+//   caster's reply) -> STREAMING
+// and any failure or timeout goes back to IDLE until the next reconnect slot.
+enum class CasterState {
+    IDLE,
+    CONNECTING,
+    REQUEST_SENT,
+    STREAMING
+};
 
-enum class NTRIPError {
-    NONE,
-    CONNECTION_FAILED,
-    TIMEOUT,
-    INVALID_RESPONSE,
-    INVALID_CONFIG,
-    AUTH_FAILED,
-    RTCM_TIMEOUT,
-    SURVEY_IN_ACTIVE,
-    BUFFER_OVERFLOW
+struct Caster {
+    Caster()
+        : number(0), status{false, 0, NTRIPError::NONE, 0, 0, 1, 0, 0, 0, 0, 0, NTRIP_RECONNECT_DELAY_MS, 0}, task(nullptr),  // Default to NTRIP 1.0
+          state(CasterState::IDLE), pendingFd(-1), address(), addressValid(false), requestVersion(1),
+          handshakeStart_ms(0), responseLen(0),
+          previousConnectAttempt(0), writeFailedAt_ms(0), lastHealthCheck_ms(0), lastReport_ms(0),
+          latencyAvg_us(0), latencyMax_us(0), staleDrops(0), heldFrames(0), limitDrops(0),
+          burstPending(false), burstFrames(0), epochEndFiltered(false), reduceMsm(false), reducedFrames(0),
+          reducedBytesSaved(0), coalesce(true), pendingCount(0), pendingSince_us(0),
+          epochs(0), segments(0), epochLatencyAvg_us(0), epochLatencyMax_us(0), correctionAge() {}
+
+    int number;                        // 1-based slot number, as in the settings keys
+    WiFiClient client;
+    NTRIPStatus status;
+    CasterQueue queue;
+    TaskHandle_t task;
+    CasterState state;
+    int pendingFd;                     // Socket of a connect in progress, owned by client afterwards
+    struct sockaddr_in address;        // Resolved casterHost<n>, reused until a connect to it fails
+    bool addressValid;
+    int requestVersion;                // NTRIP version of the handshake in progress
+    unsigned long handshakeStart_ms;
+    char response[256];                // Caster reply collected during REQUEST_SENT
+    int responseLen;
+    unsigned long previousConnectAttempt;
+    unsigned long writeFailedAt_ms;    // Set while recovering from a failed or stalled write
+    unsigned long lastHealthCheck_ms;  // Rate limit health checks
+    unsigned long lastReport_ms;
+    uint32_t latencyAvg_us;            // Enqueue-to-send, moving average over ~8 frames
+    uint32_t latencyMax_us;
+    uint32_t staleDrops;
+    std::atomic<int> heldFrames;       // Pool slots queued or pending for this caster
+    uint32_t limitDrops;               // Frames not queued because heldFrames was at its limit, GNSS UART task only
+    std::atomic<bool> burstPending;    // Set on handshake, the UART task queues the station frames
+    uint32_t burstFrames;              // Station frames sent after handshakes
+    InjectSchedule inject;             // Firmware-generated messages, GNSS UART task only
+    RtcmFilter filter;                 // Message types this caster gets (setting filter<n>), GNSS UART task only
+    std::atomic<bool> epochEndFiltered;  // The filter dropped the last MSM of an epoch, flush what's pending
+    bool reduceMsm;                    // Send MSM7 as MSM4 (setting reduceMsm<n>)
+    uint32_t reducedFrames;            // MSM7 frames sent as MSM4, and the bytes that saved
+    uint32_t reducedBytesSaved;
+    bool coalesce;
+    QueuedFrame pending[CASTER_EPOCH_MAX_FRAMES];  // Frames of the epoch being coalesced
+    int pendingCount;
+    unsigned long pendingSince_us;     // Enqueue time of the first pending frame
+    uint32_t epochs;                   // Gather writes sent (one per epoch when coalescing)
+    uint32_t segments;                 // TCP segments those writes needed, estimated from tcpMss
+    uint32_t epochLatencyAvg_us;       // Epoch complete (last frame framed) to written, moving average
+    uint32_t epochLatencyMax_us;
+    AgeHistogram correctionAge;        // MSM epoch time to written, caster task only
 };
 
-String getErrorMessage(NTRIPError error) {
+RtcmFramePool framePool;
+RtcmFramePool::Slot *uartSlot = nullptr;  // Slot the framer is currently writing into
+RtcmFramePool::Slot *stationFrames[stationFrameTypes] = {};  // Latest frame per stationMessageTypes, GNSS UART task only
+msm::StreamStats msmStats;  // MSM header analytics of the UART stream, GNSS UART task only
+AgeHistogram uartAge;       // MSM epoch time to framed, GNSS UART task only
+InjectSchedule localInject;  // Injection schedules of the LAN outputs
+InjectSchedule rawInject;
+InjectSchedule udpInject;
+Caster casters[NTRIP_CASTER_COUNT];
+
+[[noreturn]] void casterTask(void *pvParameter);
+
+bool startConnect(Caster& caster);
+
+const char *getErrorMessage(NTRIPError error) {
     switch(error) {
+        case NTRIPError::NONE:
+            return "";
         case NTRIPError::CONNECTION_FAILED:
             return "Failed to connect to host";
         case NTRIPError::TIMEOUT:
@@ -114,123 +215,86 @@ String getErrorMessage(NTRIPError error) {
             return "RTCM data timeout";
         case NTRIPError::BUFFER_OVERFLOW:
             return "Request buffer overflow";
+        case NTRIPError::WRITE_FAILED:
+            return "Write failed";
+        case NTRIPError::WRITE_STALLED:
+            return "Write stalled";
         default:
             return "Unknown error";
     }
 }
 
-NTRIPError verifyServerResponse(WiFiClient& client) {
-    // Wait for response with timeout
-    unsigned long timeout = millis();
-    while (client.available() == 0) {
-        if ((unsigned long)(millis() - timeout) > connectionTimeout) {
-            error("Client Timeout");
-            client.stop(); // Ensure client is properly stopped
-            return NTRIPError::TIMEOUT;
-        }
-        delay(10);
-        yield();
-    }
-
-    // Check reply - safer buffer handling
-    constexpr int MAX_RESPONSE_SIZE = 512;
-    char response[MAX_RESPONSE_SIZE];
-    int responseSpot = 0;
-    
-    // Read response with buffer protection
-    while (client.available() && responseSpot < MAX_RESPONSE_SIZE - 1) {
-        response[responseSpot++] = client.read();
-        if (responseSpot >= 3) { // At least 3 characters to check for "200"
-            // Null-terminate the partial buffer for string operations
-            response[responseSpot] = '\0';
-            
-            // Accept either "ICY 200 OK" or any response with "200" status code
-            if (strstr(response, "ICY 200") || // Standard NTRIP v1 response
-                strstr(response, "HTTP/1.1 200") || // HTTP style response
-                strstr(response, "HTTP/1.0 200") || // HTTP style response
-                strstr(response, "200 OK")) { // Generic 200 OK
-                
-                // Found successful response, but keep reading to clear buffer
-                while (client.available()) {
-                    client.read(); // Clear remaining bytes
-                    yield();
-                }
-                debug("Caster response OK");
-                return NTRIPError::NONE;
-            }
-            
-            // Check for authentication errors
-            if (strstr(response, "401 Unauthorized") || 
-                strstr(response, "403 Forbidden")) {
-                errorf("Authentication failed: %s", response);
-                client.stop();
-                return NTRIPError::AUTH_FAILED;
-            }
-        }
-        yield();
+// Classify the caster's reply collected so far. Returns false while it's still
+// inconclusive (the status line isn't complete) and more bytes should be read.
+bool parseServerResponse(const char *response, NTRIPError &result) {
+    // Accept either "ICY 200 OK" or any response with "200" status code
+    if (strstr(response, "ICY 200") || // Standard NTRIP v1 response
+        strstr(response, "HTTP/1.1 200") || // HTTP style response
+        strstr(response, "HTTP/1.0 200") || // HTTP style response
+        strstr(response, "200 OK")) { // Generic 200 OK
+        result = NTRIPError::NONE;
+        return true;
     }
-    
-    // Ensure null termination
-    response[responseSpot < MAX_RESPONSE_SIZE ? responseSpot : MAX_RESPONSE_SIZE - 1] = '\0';
 
-    errorf("Failed to verify server response: %s", response);
-    client.stop(); // Ensure client is properly stopped
-    return NTRIPError::INVALID_RESPONSE;
-}
-
-void handleError(bool isPrimary, NTRIPError error) {
-    String prefix = isPrimary ? "Primary" : "Secondary";
-    String errorMsg = getErrorMessage(error);
+    // Check for authentication errors
+    if (strstr(response, "401 Unauthorized") ||
+        strstr(response, "403 Forbidden") ||
+        strstr(response, "ERROR - Bad Password")) {  // NTRIP v1
+        result = NTRIPError::AUTH_FAILED;
+        return true;
+    }
 
-    errorf("NTRIP %s - %s", prefix.c_str(), errorMsg.c_str());
+    // Any other complete status line, e.g. a v1 "ERROR - Mount Point Taken or Invalid"
+    if (strchr(response, '\n') != nullptr) {
+        result = NTRIPError::INVALID_RESPONSE;
+        return true;
+    }
+    return false;
+}
 
-    if (isPrimary) {
-        NtripPrimaryStatus.lastError = errorMsg;
-        // Only increment reconnect attempts for connection related errors
-        if (error == NTRIPError::CONNECTION_FAILED || 
-            error == NTRIPError::TIMEOUT || 
-            error == NTRIPError::AUTH_FAILED) {
-            NtripPrimaryStatus.reconnectAttempts++;
-        }
-    } else {
-        NtripSecondaryStatus.lastError = errorMsg;
-        // Only increment reconnect attempts for connection related errors
-        if (error == NTRIPError::CONNECTION_FAILED || 
-            error == NTRIPError::TIMEOUT || 
-            error == NTRIPError::AUTH_FAILED) {
-            NtripSecondaryStatus.reconnectAttempts++;
-        }
+void handleError(Caster& caster, NTRIPError error) {
+    errorf("NTRIP Caster %d - %s", caster.number, getErrorMessage(error));
+
+    caster.status.lastError = error;
+    // Only increment reconnect attempts for connection related errors
+    if (error == NTRIPError::CONNECTION_FAILED ||
+        error == NTRIPError::TIMEOUT ||
+        error == NTRIPError::AUTH_FAILED) {
+        caster.status.reconnectAttempts++;
+        caster.status.backoff_ms = backoff::delay(reconnectDelay, maxReconnectDelay,
+                                                  caster.status.reconnectAttempts, esp_random());
     }
 }
 
-bool stopNTRIP(WiFiClient& client, bool isPrimary)
+bool stopNTRIP(Caster& caster)
 {
-    debug(isPrimary ? "Disconnecting primary NTRIP..." : "Disconnecting secondary NTRIP...");
-
-    client.stop();
-    infof("NTRIP %s - Disconnected", isPrimary ? "Primary" : "Secondary");
-    
-    if (isPrimary) {
-        // Preserve reconnection attempts and last error when disconnecting
-        NTRIPStatus newStatus = NtripPrimaryStatus;
-        newStatus.connected = false;
-        newStatus.bytesSent = 0;
-        newStatus.connectionOpenedAt = 0;
-        NtripPrimaryStatus = newStatus;
-    } else {
-        // Preserve reconnection attempts and last error when disconnecting
-        NTRIPStatus newStatus = NtripSecondaryStatus;
-        newStatus.connected = false;
-        newStatus.bytesSent = 0;
-        newStatus.connectionOpenedAt = 0;
-        NtripSecondaryStatus = newStatus;
+    debugf("Disconnecting NTRIP caster %d...", caster.number);
+
+    if (caster.pendingFd >= 0) {
+        close(caster.pendingFd);  // Connect still in progress, not yet owned by client
+        caster.pendingFd = -1;
     }
+    caster.client.stop();
+    caster.state = CasterState::IDLE;
+    infof("NTRIP Caster %d - Disconnected", caster.number);
+
+    // Preserve reconnection attempts and last error when disconnecting. Field by field,
+    // the web task reads the status while this runs.
+    caster.status.connected = false;
+    caster.status.bytesSent = 0;
+    caster.status.connectionOpenedAt = 0;
     return true;
 }
 
+bool stopNTRIP(const int index) {
+    return stopNTRIP(casters[index]);
+}
+
 
 // Replace the checkConnectionHealth function with this improved version
-NTRIPError checkConnectionHealth(WiFiClient& client, NTRIPStatus& status, bool isPrimary) {
+NTRIPError checkConnectionHealth(Caster& caster) {
+    WiFiClient& client = caster.client;
+    const NTRIPStatus& status = caster.status;
     const unsigned long currentMillis = millis();
 
     // If we're in the stability period, skip health checks entirely
@@ -246,7 +310,7 @@ NTRIPError checkConnectionHealth(WiFiClient& client, NTRIPStatus& status, bool i
     // use client.connected() for health checking as it's unreliable for upload-only streams.
     //
     // Instead, rely on:
-    // 1. Write failures (detected in send_rtcm)
+    // 1. Write failures and stalls (detected in sendEpoch, which fails over at once)
     // 2. RTCM timeout (handled by RTCMCheck)
     // 3. Check if server has sent us data (error response or close notification)
 
@@ -256,11 +320,11 @@ NTRIPError checkConnectionHealth(WiFiClient& client, NTRIPStatus& status, bool i
         int bytesRead = client.readBytesUntil('\n', serverResponse, sizeof(serverResponse) - 1);
         if (bytesRead > 0) {
             serverResponse[bytesRead] = '\0';
-            warningf("NTRIP %s - Server sent: %s", isPrimary ? "Primary" : "Secondary", serverResponse);
+            warningf("NTRIP Caster %d - Server sent: %s", caster.number, serverResponse);
 
             // If server sent data and connection is now closed, server initiated close
             if (!client.connected()) {
-                errorf("NTRIP %s - Server closed connection", isPrimary ? "Primary" : "Secondary");
+                errorf("NTRIP Caster %d - Server closed connection", caster.number);
                 return NTRIPError::CONNECTION_FAILED;
             }
         }
@@ -269,8 +333,8 @@ NTRIPError checkConnectionHealth(WiFiClient& client, NTRIPStatus& status, bool i
     // Check if connection is closed WITHOUT any pending data
     // This means either: server sent FIN without data, or network error
     if (!client.connected() && client.available() == 0) {
-        warningf("NTRIP %s - Connection closed (likely server-initiated or network issue)",
-                 isPrimary ? "Primary" : "Secondary");
+        warningf("NTRIP Caster %d - Connection closed (likely server-initiated or network issue)",
+                 caster.number);
         return NTRIPError::CONNECTION_FAILED;
     }
 
@@ -312,99 +376,130 @@ NTRIPError RTCMCheck() {
     return NTRIPError::NONE;
 }
 
-void handleNTRIP()
+void advanceHandshake(Caster& caster);
+
+// Connection upkeep of one caster, runs in that caster's task
+void handleCaster(Caster &caster)
 {
-    static unsigned long previousConnectAttempt = 0;
-    // Remove duplicate counter as we already have reconnectAttempts in the status structs
+    NTRIPStatus &status = caster.status;
     const unsigned long currentMillis = millis();
 
-    // Calculate the appropriate delay based on max of both connection attempts
-    int maxAttempts = max(NtripPrimaryStatus.reconnectAttempts, NtripSecondaryStatus.reconnectAttempts);
-    unsigned long connectInterval = (maxAttempts >= maxReconnectAttempts) ? slowReconnectDelay : reconnectDelay;
+    // Back off based on this caster's own failed attempts
+    const unsigned long connectInterval = status.backoff_ms;
+
+    // Only a connection that stayed up resets the backoff, not one the caster drops right after the handshake
+    if (status.connected && status.reconnectAttempts > 0 &&
+        (unsigned long)(currentMillis - status.connectionOpenedAt) >= connectionStabilityTimeout_ms) {
+        status.reconnectAttempts = 0;
+        status.backoff_ms = reconnectDelay;
+    }
 
     // Check if we should be connected based on RTCM data
     NTRIPError rtcmError = RTCMCheck();
-    
-    // If RTCM check fails, disconnect any existing connections
+
+    // If RTCM check fails, disconnect the existing connection or abort the handshake
     if (rtcmError != NTRIPError::NONE) {
-        if (NtripPrimaryStatus.connected) {
-            handleError(true, rtcmError);
-            stopNTRIP(client, true);
-        }
-        
-        if (NtripSecondaryStatus.connected) {
-            handleError(false, rtcmError);
-            stopNTRIP(client2, false);
+        if (caster.state != CasterState::IDLE) {
+            handleError(caster, rtcmError);
+            stopNTRIP(caster);
         }
+        status.nextAttempt_ms = 0;
         return; // Don't proceed with connection attempts
     }
 
-    // Monitor existing connections only if RTCM check passed
+    // Monitor the existing connection only if RTCM check passed
     // Rate limit health checks to every 5 seconds to avoid false positives during data transfer
-    if ((unsigned long)(currentMillis - lastHealthCheck_ms) >= 5000) {
-        lastHealthCheck_ms = currentMillis;
-
-        NTRIPError primaryError = NtripPrimaryStatus.connected ?
-            checkConnectionHealth(client, NtripPrimaryStatus, true) : NTRIPError::NONE;
-
-        if (primaryError != NTRIPError::NONE && NtripPrimaryStatus.connected) {
-            handleError(true, primaryError);
-            stopNTRIP(client, true);
-        }
+    if ((unsigned long)(currentMillis - caster.lastHealthCheck_ms) >= 5000) {
+        caster.lastHealthCheck_ms = currentMillis;
 
-        NTRIPError secondaryError = NtripSecondaryStatus.connected ?
-            checkConnectionHealth(client2, NtripSecondaryStatus, false) : NTRIPError::NONE;
+        NTRIPError healthError = status.connected ?
+            checkConnectionHealth(caster) : NTRIPError::NONE;
 
-        if (secondaryError != NTRIPError::NONE && NtripSecondaryStatus.connected) {
-            handleError(false, secondaryError);
-            stopNTRIP(client2, false);
+        if (healthError != NTRIPError::NONE && status.connected) {
+            handleError(caster, healthError);
+            stopNTRIP(caster);
         }
     }
 
     // Try to connect if not already connected and enough time has passed
     // Handle millis() overflow by using subtraction (works correctly even with overflow)
-    bool timeToReconnect = (previousConnectAttempt == 0) || 
-                          ((unsigned long)(currentMillis - previousConnectAttempt) >= connectInterval);
-                          
-    if (timeToReconnect) {
-        previousConnectAttempt = currentMillis;
-        
-        // Only try to connect primary if not connected
-        if (!NtripPrimaryStatus.connected) {
-            if (!checkAndConnect(client, NtripPrimaryStatus, true)) {
-                // Connection attempt failed, increment is handled in handleError
-            }
-        }
-        
-        // Only try to connect secondary if not connected
-        if (!NtripSecondaryStatus.connected) {
-            if (!checkAndConnect(client2, NtripSecondaryStatus, false)) {
-                // Connection attempt failed, increment is handled in handleError
-            }
-        }
+    bool timeToReconnect = (caster.previousConnectAttempt == 0) ||
+                          ((unsigned long)(currentMillis - caster.previousConnectAttempt) >= connectInterval);
+
+    if (caster.state == CasterState::IDLE && timeToReconnect) {
+        caster.previousConnectAttempt = currentMillis;
+        // Connection attempt failures are counted in handleError
+        startConnect(caster);
+    }
+    if (caster.state == CasterState::CONNECTING || caster.state == CasterState::REQUEST_SENT) {
+        advanceHandshake(caster);
     }
+    status.nextAttempt_ms = caster.state == CasterState::IDLE && caster.previousConnectAttempt != 0 ?
+                            caster.previousConnectAttempt + status.backoff_ms : 0;
 
     // Report statistics every 10 seconds
     // Handle millis() overflow safely
-    if ((unsigned long)(currentMillis - lastReport_ms) > 10000) {
-        lastReport_ms = currentMillis;
-        debugf("NTRIP Status - Primary: %s (%d bytes, %d attempts), Secondary: %s (%d bytes, %d attempts)",
-            NtripPrimaryStatus.connected ? "Connected" : "Disconnected",
-            NtripPrimaryStatus.bytesSent,
-            NtripPrimaryStatus.reconnectAttempts,
-            NtripSecondaryStatus.connected ? "Connected" : "Disconnected",
-            NtripSecondaryStatus.bytesSent,
-            NtripSecondaryStatus.reconnectAttempts);
+    if ((unsigned long)(currentMillis - caster.lastReport_ms) > 10000) {
+        caster.lastReport_ms = currentMillis;
+        debugf("NTRIP Caster %d - %s (%d bytes, %d attempts), queue drops %u, stale %u, over pool share %u, high water %u/%u, latency avg %u us max %u us",
+            caster.number,
+            status.connected ? "Connected" : "Disconnected",
+            status.bytesSent,
+            status.reconnectAttempts,
+            caster.queue.drop_count(), caster.staleDrops, caster.limitDrops,
+            caster.queue.high_water_mark(), (unsigned)CasterQueue::capacity(),
+            caster.latencyAvg_us, caster.latencyMax_us);
+        debugf("NTRIP Caster %d - %u epochs, %u segments, epoch-to-wire avg %u us max %u us",
+            caster.number, caster.epochs, caster.segments, caster.epochLatencyAvg_us, caster.epochLatencyMax_us);
+        if (caster.number == 1) {
+            // The pool is shared, report it once
+            debugf("RTCM frame pool - %u/%u slots in use, %u exhausted",
+                (unsigned)framePool.in_use(), (unsigned)framePool.capacity(), framePool.exhausted_count());
+        }
     }
 }
 
-bool checkAndConnect(WiFiClient& client, NTRIPStatus& status, const bool isPrimary) {
-    const bool isEnabled = isPrimary ?
-        settings["enableCaster1"].as<bool>() :
-        settings["enableCaster2"].as<bool>();
+// Abandon a connect/handshake in progress
+void failHandshake(Caster& caster, NTRIPError error) {
+    handleError(caster, error);
+    stopNTRIP(caster);
+}
+
+// Fill caster.address for host. getaddrinfo() blocks the caster task for as long
+// as the DNS server takes, so a name is only looked up again once a connect to
+// the cached address failed; IP addresses never need a lookup. Time spent here
+// counts against the handshake timeout.
+static bool resolveCaster(Caster& caster, const char *host) {
+    if (caster.addressValid) {
+        return true;
+    }
+    memset(&caster.address, 0, sizeof(caster.address));
+    caster.address.sin_family = AF_INET;
+    if (inet_aton(host, &caster.address.sin_addr) == 0) {
+        struct addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        struct addrinfo *resolved = nullptr;
+        const unsigned long lookupStart_ms = millis();
+        if (getaddrinfo(host, nullptr, &hints, &resolved) != 0 || resolved == nullptr) {
+            return false;
+        }
+        caster.address.sin_addr = ((struct sockaddr_in *)resolved->ai_addr)->sin_addr;
+        freeaddrinfo(resolved);
+        debugf("NTRIP Caster %d - Resolved %s in %lu ms", caster.number, host, millis() - lookupStart_ms);
+    }
+    caster.addressValid = true;
+    return true;
+}
+
+// Resolve the caster and start a non-blocking TCP connect (IDLE -> CONNECTING)
+bool startConnect(Caster& caster) {
+    NTRIPStatus& status = caster.status;
+    const int n = caster.number;
+    const bool isEnabled = settings[casterKey("enableCaster", n)].as<bool>();
 
     if (!isEnabled && status.connected) {
-        stopNTRIP(client, isPrimary);
+        stopNTRIP(caster);
         return false;
     }
 
@@ -412,248 +507,723 @@ bool checkAndConnect(WiFiClient& client, NTRIPStatus& status, const bool isPrima
         return false;
     }
 
-    // If already connected according to status, nothing to do
-    // Don't call client.connected() here as it can return false during writes
-    if (status.connected) {
-        return true;
-    }
-
     // Check if RTCM data is available
     NTRIPError rtcmError = RTCMCheck();
     if (rtcmError != NTRIPError::NONE) {
-        handleError(isPrimary, rtcmError);
+        handleError(caster, rtcmError);
         return false; // Don't attempt to connect if RTCM check fails
     }
 
-    // If we get here, we should attempt to connect
-    const char* host = isPrimary ? settings["casterHost1"] : settings["casterHost2"];
-    uint16_t port = isPrimary ? settings["casterPort1"].as<uint16_t>() : settings["casterPort2"].as<uint16_t>();
-    const char* pw = isPrimary ? settings["rtk_mntpnt_pw1"] : settings["rtk_mntpnt_pw2"];
-    const char* user = isPrimary ? settings["rtk_mntpnt_user1"] : settings["rtk_mntpnt_user2"];
-    const char* mnt = isPrimary ? settings["rtk_mntpnt1"] : settings["rtk_mntpnt2"];
-    
+    const char* host = settings[casterKey("casterHost", n)];
+    uint16_t port = settings[casterKey("casterPort", n)].as<uint16_t>();
+
     // Get the appropriate version setting for this mount point
-    int ntripVersion;
-    
-    if (isPrimary) {
-        if (settings.containsKey("ntripVersion1")) {
-            ntripVersion = settings["ntripVersion1"].as<int>();
-        } else {
-            ntripVersion = 1; // Default to 1.0
-        }
-    } else {
-        if (settings.containsKey("ntripVersion2")) {
-            ntripVersion = settings["ntripVersion2"].as<int>();
-        } else {
-            ntripVersion = 1; // Default to 1.0
+    const String versionKey = casterKey("ntripVersion", n);
+    caster.requestVersion = settings.containsKey(versionKey) ? settings[versionKey].as<int>() : 1; // Default to 1.0
+
+    debugf("NTRIP Caster %d - Attempting connection to %s:%d (Version %d)", n, host, port, caster.requestVersion);
+    caster.handshakeStart_ms = millis();
+
+    if (!resolveCaster(caster, host)) {
+        errorf("NTRIP Caster %d - Could not resolve %s", n, host);
+        handleError(caster, NTRIPError::CONNECTION_FAILED);
+        return false;
+    }
+    struct sockaddr_in addr = caster.address;
+    addr.sin_port = htons(port);
+
+    const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) {
+        handleError(caster, NTRIPError::CONNECTION_FAILED);
+        return false;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(fd);
+        caster.addressValid = false;
+        handleError(caster, NTRIPError::CONNECTION_FAILED);
+        return false;
+    }
+
+    caster.pendingFd = fd;
+    caster.state = CasterState::CONNECTING;
+    return true;
+}
+
+// Format the NTRIP request for this caster into buffer, returns the length
+// snprintf wanted (>= size means truncated)
+int buildRequest(const Caster& caster, char *buffer, const size_t size) {
+    const int n = caster.number;
+    const char* host = settings[casterKey("casterHost", n)];
+    const char* pw = settings[casterKey("rtk_mntpnt_pw", n)];
+    const char* user = settings[casterKey("rtk_mntpnt_user", n)];
+    const char* mnt = settings[casterKey("rtk_mntpnt", n)];
+
+    if (caster.requestVersion == 2) {
+        // NTRIP Rev 2.0: Use HTTP/1.1 POST with Basic Auth
+        String auth = String(user) + ":" + String(pw);
+        String base64Auth = base64_encode(auth);
+
+        return snprintf(buffer, size,
+            "POST /%s HTTP/1.1\r\n"
+            "Host: %s\r\n"
+            "User-Agent: NTRIP %s/App Version %s\r\n"
+            "Authorization: Basic %s\r\n"
+            "Ntrip-Version: Ntrip/2.0\r\n"
+            "Connection: close\r\n\r\n",
+            mnt, host,
+            settings["ntrip_sName"].as<const char*>(),
+            FIRMWARE_VERSION,
+            base64Auth.c_str()
+        );
+    }
+    // NTRIP Rev 1.0: Custom 'SOURCE' method
+    return snprintf(buffer, size,
+        "SOURCE %s /%s\r\n"
+        "Source-Agent: NTRIP %s/App Version %s\r\n\r\n",
+        pw, mnt,
+        settings["ntrip_sName"].as<const char*>(),
+        FIRMWARE_VERSION
+    );
+}
+
+// One non-blocking step of CONNECTING or REQUEST_SENT
+void advanceHandshake(Caster& caster) {
+    NTRIPStatus& status = caster.status;
+    const int n = caster.number;
+
+    if ((unsigned long)(millis() - caster.handshakeStart_ms) > connectionTimeout) {
+        if (caster.state == CasterState::CONNECTING) {
+            caster.addressValid = false;  // Look the name up again, the host may have moved
         }
+        failHandshake(caster, NTRIPError::TIMEOUT);
+        return;
     }
 
-    debugf("NTRIP %s - Attempting connection to %s:%d (Version %d)", isPrimary ? "Primary" : "Secondary", host, port, ntripVersion);
+    if (caster.state == CasterState::CONNECTING) {
+        const int fd = caster.pendingFd;
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(fd, &writable);
+        struct timeval noWait = {0, 0};
+        const int ready = select(fd + 1, nullptr, &writable, nullptr, &noWait);
+        if (ready == 0) {
+            return;  // Still connecting
+        }
+        int socketError = 0;
+        socklen_t errorLen = sizeof(socketError);
+        if (ready < 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &errorLen) < 0 || socketError != 0) {
+            caster.addressValid = false;
+            failHandshake(caster, NTRIPError::CONNECTION_FAILED);
+            return;
+        }
+
+        // Connected: hand the socket to a WiFiClient in blocking mode, as its connect() leaves it.
+        // The send timeout bounds every write to the stall threshold, so a half-open
+        // connection fails the write instead of blocking until TCP gives up.
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+        struct timeval sendTimeout;
+        sendTimeout.tv_sec = writeStallTimeout_ms / 1000;
+        sendTimeout.tv_usec = (writeStallTimeout_ms % 1000) * 1000;
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+        caster.client = WiFiClient(fd);
+        caster.pendingFd = -1;
 
-    if (client.connect(host, port, connectionTimeout)) {
         // Disable Nagle's algorithm for real-time RTCM streaming
         // This prevents TCP from batching small packets, ensuring immediate delivery
-        client.setNoDelay(true);
+        caster.client.setNoDelay(true);
 
         char serverBuffer[NTRIP_SERVER_BUFFER_SIZE];
-        int bytesWritten = 0;
-
-        if (ntripVersion == 2) {
-            // NTRIP Rev 2.0: Use HTTP/1.1 POST with Basic Auth
-            String auth = String(user) + ":" + String(pw);
-            String base64Auth = base64_encode(auth);
-
-            bytesWritten = snprintf(serverBuffer, NTRIP_SERVER_BUFFER_SIZE,
-                "POST /%s HTTP/1.1\r\n"
-                "Host: %s\r\n"
-                "User-Agent: NTRIP %s/App Version %s\r\n"
-                "Authorization: Basic %s\r\n"
-                "Ntrip-Version: Ntrip/2.0\r\n"
-                "Connection: close\r\n\r\n",
-                mnt, host,
-                settings["ntrip_sName"].as<const char*>(),
-                FIRMWARE_VERSION,
-                base64Auth.c_str()
-            );
-        } else {
-            // NTRIP Rev 1.0: Custom 'SOURCE' method
-            bytesWritten = snprintf(serverBuffer, NTRIP_SERVER_BUFFER_SIZE,
-                "SOURCE %s /%s\r\n"
-                "Source-Agent: NTRIP %s/App Version %s\r\n\r\n",
-                pw, mnt,
-                settings["ntrip_sName"].as<const char*>(),
-                FIRMWARE_VERSION
-            );
-        }
+        const int bytesWritten = buildRequest(caster, serverBuffer, sizeof(serverBuffer));
 
         // Check if buffer was truncated
         if (bytesWritten >= NTRIP_SERVER_BUFFER_SIZE) {
             errorf("NTRIP request buffer overflow: needed %d bytes, have %d", bytesWritten, NTRIP_SERVER_BUFFER_SIZE);
-            client.stop();
-            status.connected = false;
-            handleError(isPrimary, NTRIPError::BUFFER_OVERFLOW);
-            return false;
+            failHandshake(caster, NTRIPError::BUFFER_OVERFLOW);
+            return;
         }
 
-        client.write(serverBuffer, strlen(serverBuffer));
+        caster.client.write(serverBuffer, bytesWritten);
+        caster.responseLen = 0;
+        caster.state = CasterState::REQUEST_SENT;
+        return;
+    }
 
-        // Wait for and verify response
-        NTRIPError responseError = verifyServerResponse(client);
-        
-        if (responseError == NTRIPError::NONE) {
-            status.connected = true;
-            status.reconnectAttempts = 0; // Reset attempts on successful connection
-            status.lastError = "";
-            status.connectionOpenedAt = millis();
-            status.protocolVersion = ntripVersion;  // Store the protocol version
-            infof("NTRIP %s - Connected to %s", isPrimary ? "Primary" : "Secondary", host);
-            return true;
-        } else {
-            // Connection failed during verification
-            handleError(isPrimary, responseError);
-            return false;
+    // REQUEST_SENT: collect whatever part of the reply has arrived
+    const ssize_t received = recv(caster.client.fd(), caster.response + caster.responseLen,
+                                  sizeof(caster.response) - 1 - caster.responseLen, MSG_DONTWAIT);
+    if (received > 0) {
+        caster.responseLen += received;
+    }
+    caster.response[caster.responseLen] = '\0';
+
+    NTRIPError responseError;
+    if (!parseServerResponse(caster.response, responseError)) {
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            // Closed or reset before a complete status line, a v1 caster may just hang up
+            errorf("NTRIP Caster %d - Server closed the connection during the handshake: %s", n, caster.response);
+            failHandshake(caster, NTRIPError::CONNECTION_FAILED);
+        } else if (caster.responseLen == (int)sizeof(caster.response) - 1) {
+            errorf("Failed to verify server response: %s", caster.response);
+            failHandshake(caster, NTRIPError::INVALID_RESPONSE);
         }
-    } else {
-        // Connection failed to establish
-        handleError(isPrimary, NTRIPError::CONNECTION_FAILED);
-        return false;
+        return;  // Wait for more of the reply
+    }
+
+    if (responseError == NTRIPError::AUTH_FAILED) {
+        errorf("Authentication failed: %s", caster.response);
+        failHandshake(caster, responseError);
+        return;
+    }
+    if (responseError != NTRIPError::NONE) {
+        errorf("Failed to verify server response: %s", caster.response);
+        failHandshake(caster, responseError);
+        return;
+    }
+
+    // Found successful response, drop the rest of the reply
+    while (caster.client.available()) {
+        caster.client.read();
+    }
+    debug("Caster response OK");
+
+    caster.burstPending.store(true);  // Before connected, so no live frame gets ahead of the burst
+    status.connected = true;
+    status.lastError = NTRIPError::NONE;  // Attempts are reset once the connection proved stable
+    status.connectionOpenedAt = millis();
+    status.protocolVersion = caster.requestVersion;  // Store the protocol version
+    status.lastHandshake_ms = status.connectionOpenedAt - caster.handshakeStart_ms;
+    caster.state = CasterState::STREAMING;
+    infof("NTRIP Caster %d - Connected to %s in %lu ms", n, settings[casterKey("casterHost", n)].as<const char*>(),
+          status.lastHandshake_ms);
+
+    if (caster.writeFailedAt_ms != 0) {
+        status.lastRecovery_ms = status.connectionOpenedAt - caster.writeFailedAt_ms;
+        if (status.lastRecovery_ms > status.maxRecovery_ms) {
+            status.maxRecovery_ms = status.lastRecovery_ms;
+        }
+        caster.writeFailedAt_ms = 0;
+        infof("NTRIP Caster %d - Recovered from write failure in %lu ms", n, status.lastRecovery_ms);
     }
 }
 
-void send_rtcm(const uint8_t *data, const int len) {
-    // Reduced verbosity - only log once per message, not every byte
-    if (len > 0) {
-        debugf("RTCM data received: %d bytes", len);
+// A caster that can't take a write is treated as gone: drop the connection and
+// reconnect on the next tick instead of waiting for the health check and
+// reconnectDelay, so rovers lose seconds of corrections rather than minutes
+void failWrite(Caster& caster, const NTRIPError error) {
+    handleError(caster, error);
+    stopNTRIP(caster);
+    caster.previousConnectAttempt = 0;
+    if (caster.writeFailedAt_ms == 0) {
+        caster.writeFailedAt_ms = millis();  // Keep the first failure if reconnecting fails too
     }
+}
 
-    // Update timestamp - we received valid RTCM data that passed filtering
-    lastRtcmData_ms = millis();
+// Return a frame queued with queueToCaster() to the pool
+static void releaseFromCaster(Caster& caster, RtcmFramePool::Slot *slot) {
+    caster.heldFrames--;
+    RtcmFramePool::release(slot);
+}
 
-    // Thread-safe access to status - hold mutex for entire critical section
-    if (xSemaphoreTake(statusMutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        bool primaryConnected = NtripPrimaryStatus.connected;
-        int primaryVersion = NtripPrimaryStatus.protocolVersion;
-        bool secondaryConnected = NtripSecondaryStatus.connected;
-        int secondaryVersion = NtripSecondaryStatus.protocolVersion;
-
-        // Don't release mutex yet - we need it for updating bytesSent
-
-        if (primaryConnected) {
-            size_t bytesWritten = 0;
-            if (primaryVersion == 2) {
-                // Format as HTTP chunked transfer
-                char chunkHeader[10];
-                snprintf(chunkHeader, sizeof(chunkHeader), "%X\r\n", len);
-                size_t headerWritten = client.write((const uint8_t *)chunkHeader, strlen(chunkHeader));
-                size_t dataWritten = client.write(data, len);
-                size_t trailerWritten = client.write("\r\n", 2);
-
-                // Flush immediately to prevent TCP buffering and ensure real-time delivery
-                // This is critical for RTCM corrections which need consistent 1Hz timing
-                client.flush();
-
-                // Check if all writes succeeded
-                if (headerWritten != strlen(chunkHeader) || dataWritten != (size_t)len || trailerWritten != 2) {
-                    errorf("NTRIP Primary - Write failed: expected %d bytes, wrote %d",
-                           len + strlen(chunkHeader) + 2, headerWritten + dataWritten + trailerWritten);
-                    // Don't update bytesSent on failure
-                } else {
-                    bytesWritten = dataWritten;
-                }
+// Write the pending frames with a single writev(), raw for NTRIP 1.0 or as their
+// pre-encoded HTTP chunks for 2.0, then return them to the pool. Only called
+// from the caster's own task, which owns the connection. Every write is timed;
+// a failed or stalled one fails the connection over at once.
+void sendEpoch(Caster& caster) {
+    NTRIPStatus& status = caster.status;
+    const int count = caster.pendingCount;
+    if (count == 0) {
+        return;
+    }
+
+    bool failed = false;
+    bool stalled = false;
+    if (status.connected) {
+        struct iovec iov[CASTER_EPOCH_MAX_FRAMES];
+        const bool chunked = status.protocolVersion == 2;
+        size_t payloadLen = 0;
+        size_t totalLen = 0;
+
+        for (int i = 0; i < count; i++) {
+            RtcmFramePool::Slot *slot = caster.pending[i].slot;
+            const uint8_t *frame = frameData(slot);
+            if (chunked) {
+                iov[i].iov_base = (void *)chunk_frame::chunk_start(frame, slot->len);
+                iov[i].iov_len = chunk_frame::chunk_len(slot->len);
             } else {
-                // NTRIP 1.0: send raw RTCM data
-                bytesWritten = client.write(data, len);
-                if (bytesWritten != (size_t)len) {
-                    errorf("NTRIP Primary - Write failed: expected %d bytes, wrote %d", len, bytesWritten);
-                }
+                iov[i].iov_base = (void *)frame;
+                iov[i].iov_len = slot->len;
             }
+            payloadLen += slot->len;
+            totalLen += iov[i].iov_len;
+        }
 
-            // Update bytes sent only if write succeeded
-            if (bytesWritten > 0) {
-                NtripPrimaryStatus.bytesSent += bytesWritten;
-            }
+        const unsigned long writeStart_ms = millis();
+        const ssize_t written = writev(caster.client.fd(), iov, count);
+        const unsigned long sent_us = micros();
+        const unsigned long writeTime_ms = millis() - writeStart_ms;
+        if (writeTime_ms > status.slowestWrite_ms) {
+            status.slowestWrite_ms = writeTime_ms;
         }
 
-        if (secondaryConnected) {
-            size_t bytesWritten = 0;
-            if (secondaryVersion == 2) {
-                // Format as HTTP chunked transfer
-                char chunkHeader[10];
-                snprintf(chunkHeader, sizeof(chunkHeader), "%X\r\n", len);
-                size_t headerWritten = client2.write((const uint8_t *)chunkHeader, strlen(chunkHeader));
-                size_t dataWritten = client2.write(data, len);
-                size_t trailerWritten = client2.write("\r\n", 2);
-
-                // Flush immediately to prevent TCP buffering and ensure real-time delivery
-                // This is critical for RTCM corrections which need consistent 1Hz timing
-                client2.flush();
-
-                // Check if all writes succeeded
-                if (headerWritten != strlen(chunkHeader) || dataWritten != (size_t)len || trailerWritten != 2) {
-                    errorf("NTRIP Secondary - Write failed: expected %d bytes, wrote %d",
-                           len + strlen(chunkHeader) + 2, headerWritten + dataWritten + trailerWritten);
-                    // Don't update bytesSent on failure
-                } else {
-                    bytesWritten = dataWritten;
-                }
-            } else {
-                // NTRIP 1.0: send raw RTCM data
-                bytesWritten = client2.write(data, len);
-                if (bytesWritten != (size_t)len) {
-                    errorf("NTRIP Secondary - Write failed: expected %d bytes, wrote %d", len, bytesWritten);
+        if (written != (ssize_t)totalLen) {
+            // Timed out by SO_SNDTIMEO, or a partial write that left the stream mid-frame
+            stalled = writeTime_ms >= writeStallTimeout_ms || (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK));
+            failed = true;
+            errorf("NTRIP Caster %d - Write %s after %lu ms: expected %d bytes, wrote %d",
+                   caster.number, stalled ? "stalled" : "failed", writeTime_ms, (int)totalLen, (int)written);
+            // Don't update bytesSent on failure
+        } else {
+            status.bytesSent += payloadLen;
+            // Age of the corrections as they leave, the number rovers see
+            const unsigned long sent_ms = millis();
+            for (int i = 0; i < count; i++) {
+                uint32_t age_ms;
+                if (correction_age_ms(gnssClock, frameData(caster.pending[i].slot), caster.pending[i].slot->len,
+                                      sent_ms, age_ms)) {
+                    caster.correctionAge.record(age_ms);
                 }
             }
+        }
+
+        caster.epochs++;
+        caster.segments += (totalLen + tcpMss - 1) / tcpMss;
+        const uint32_t epochLatency_us = sent_us - caster.pending[count - 1].enqueued_us;
+        caster.epochLatencyAvg_us += ((int32_t)epochLatency_us - (int32_t)caster.epochLatencyAvg_us) / 8;
+        if (epochLatency_us > caster.epochLatencyMax_us) {
+            caster.epochLatencyMax_us = epochLatency_us;
+        }
+        for (int i = 0; i < count; i++) {
+            const uint32_t latency_us = sent_us - caster.pending[i].enqueued_us;
+            caster.latencyAvg_us += ((int32_t)latency_us - (int32_t)caster.latencyAvg_us) / 8;
+            if (latency_us > caster.latencyMax_us) {
+                caster.latencyMax_us = latency_us;
+            }
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        releaseFromCaster(caster, caster.pending[i].slot);
+    }
+    caster.pendingCount = 0;
+
+    if (failed) {
+        if (stalled) {
+            status.writeStalls++;
+        }
+        failWrite(caster, stalled ? NTRIPError::WRITE_STALLED : NTRIPError::WRITE_FAILED);
+    }
+}
+
+// Index into stationFrames, -1 if the type isn't cached
+static int stationFrameIndex(const int msgType) {
+    for (int i = 0; i < stationFrameTypes; i++) {
+        if (stationMessageTypes[i] == msgType) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Add a reference to a caster's queue, a full queue counts it as a drop. So
+// does a caster at its share of the pool: only this caster loses the frame.
+static bool queueToCaster(Caster &caster, RtcmFramePool::Slot *slot, const unsigned long now_us) {
+    if (caster.heldFrames.load() >= frame_pool_budget::CASTER) {
+        caster.limitDrops++;
+        return false;
+    }
+    caster.heldFrames++;  // Before the push, the caster task may release it right away
+    RtcmFramePool::retain(slot);
+    const QueuedFrame queued = {slot, now_us};
+    if (!caster.queue.push(queued)) {
+        releaseFromCaster(caster, slot);
+        return false;
+    }
+    return true;
+}
 
-            // Update bytes sent only if write succeeded
-            if (bytesWritten > 0) {
-                NtripSecondaryStatus.bytesSent += bytesWritten;
+// Queue the cached station frames for a caster that just connected. They count
+// as fresh so the stale-frame check doesn't discard them. live is skipped, it
+// is queued right after anyway, and so are types the caster's filter denies.
+static void queueStationFrames(Caster &caster, const RtcmFramePool::Slot *live, const unsigned long now_us) {
+    for (int i = 0; i < stationFrameTypes; i++) {
+        RtcmFramePool::Slot *cached = stationFrames[i];
+        if (cached != nullptr && cached != live && !caster.filter.denies(stationMessageTypes[i]) &&
+            queueToCaster(caster, cached, now_us)) {
+            caster.burstFrames++;
+        }
+    }
+}
+
+// The MSM4 version of a frame for the casters with reduceMsm<n>, converted on
+// first use so a frame is re-encoded at most once however many casters want it
+struct ReducedFrame {
+    explicit ReducedFrame(RtcmFramePool::Slot *source) : source(source), slot(nullptr) {}
+    ~ReducedFrame() {
+        if (slot != nullptr && slot != source) {
+            RtcmFramePool::release(slot);  // Drop the converter's reference
+        }
+    }
+
+    // The MSM4 frame, or source itself if it isn't an MSM7 or no slot is free
+    RtcmFramePool::Slot *get() {
+        if (slot != nullptr) {
+            return slot;
+        }
+        slot = source;
+        const int msgType = rtcmbuffer::get_rtcm_message_type(frameData(source) + 3);
+        if (!rtcmbuffer::is_msm(msgType) || msgType % 10 != 7) {
+            return slot;
+        }
+        RtcmFramePool::Slot *converted = framePool.acquire();
+        if (converted == nullptr) {
+            return slot;
+        }
+        const size_t len = msm::msm7_to_msm4(frameData(source), source->len, frameData(converted));
+        if (len == 0) {
+            RtcmFramePool::release(converted);
+            return slot;
+        }
+        converted->len = len;
+        chunk_frame::encode_chunk(frameData(converted), len);
+        slot = converted;
+        return slot;
+    }
+
+    RtcmFramePool::Slot *source;
+    RtcmFramePool::Slot *slot;
+};
+
+// Hands every valid frame from the UART framer to the casters and the LAN outputs
+struct CasterSink {
+    void operator()(const uint8_t *data, int len) const;
+};
+
+RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, CasterSink> uartFramer;
+
+void CasterSink::operator()(const uint8_t *data, int len) const {
+    // Update timestamp - we received valid RTCM data that passed filtering
+    lastRtcmData_ms = millis();
+    msmStats.add(data, len);
+    uint32_t age_ms;
+    if (correction_age_ms(gnssClock, data, len, lastRtcmData_ms, age_ms)) {
+        uartAge.record(age_ms);
+    }
+
+    bool connected[NTRIP_CASTER_COUNT];
+    bool anyConnected = false;
+    for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+        connected[i] = casters[i].status.connected;
+        anyConnected |= connected[i];
+    }
+    const bool localActive = localCaster.active();
+    const bool rawActive = rawServer.active();
+    const bool udpActive = udpOutput.active();
+    const int stationIndex = stationFrameIndex(rtcmbuffer::get_rtcm_message_type(&data[3]));
+    if (!anyConnected && !localActive && !rawActive && !udpActive && stationIndex < 0) {
+        return;  // Nobody to send to, the framer keeps reusing the current slot
+    }
+
+    RtcmFramePool::Slot *next = framePool.acquire();
+    if (next == nullptr) {
+        // Every slot is still queued for a caster: drop this frame, its slot is reused
+        return;
+    }
+
+    // data points into uartSlot, hand it over and continue framing in the next slot
+    RtcmFramePool::Slot *frame = uartSlot;
+    frame->len = len;
+    uartSlot = next;
+    uartFramer.set_buffer(frameData(next));  // Carries over any bytes after the frame first
+    chunk_frame::encode_chunk(frameData(frame), len);  // Once for all NTRIP 2.0 outputs
+
+    if (stationIndex >= 0) {
+        RtcmFramePool::retain(frame);
+        if (stationFrames[stationIndex] != nullptr) {
+            RtcmFramePool::release(stationFrames[stationIndex]);
+        }
+        stationFrames[stationIndex] = frame;
+    }
+
+    // Injected messages go out between epochs, never between the MSMs of one
+    const unsigned long now_ms = millis();
+    const unsigned long now_us = micros();
+    const bool betweenEpochs = !rtcmbuffer::is_msm(rtcmbuffer::get_rtcm_message_type(&data[3])) ||
+                               rtcmbuffer::is_epoch_end(frameData(frame), len);
+
+    ReducedFrame reduced(frame);
+    for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+        if (!connected[i]) {
+            continue;
+        }
+        Caster &caster = casters[i];
+        if (caster.burstPending.exchange(false)) {
+            // The filter saw no frames while the caster was down, start its schedule over
+            caster.filter.restart();
+            queueStationFrames(caster, frame, now_us);
+        }
+        if (caster.filter.pass(data, len, now_ms)) {
+            RtcmFramePool::Slot *send = caster.reduceMsm ? reduced.get() : frame;
+            // Only frames that are queued save anything, not ones refused by a full queue or pool share
+            if (queueToCaster(caster, send, now_us) && send != frame) {
+                caster.reducedFrames++;
+                caster.reducedBytesSaved += frame->len - send->len;
             }
+        } else if (rtcmbuffer::is_epoch_end(data, len)) {
+            caster.epochEndFiltered = true;  // Don't leave the coalesced epoch waiting for the deadline
+        }
+        if (betweenEpochs) {
+            caster.inject.run(now_ms, [&caster, now_us](RtcmFramePool::Slot *injected) {
+                if (!caster.filter.denies(rtcmbuffer::get_rtcm_message_type(frameData(injected) + 3))) {
+                    queueToCaster(caster, injected, now_us);
+                }
+            });
+        }
+        if (caster.task != nullptr) {
+            xTaskNotifyGive(caster.task);
+        }
+    }
+
+    const QueuedFrame queued = {frame, now_us};
+    if (localActive) {
+        localCaster.enqueue(queued);
+        if (betweenEpochs) {
+            localInject.run(now_ms, [now_us](RtcmFramePool::Slot *injected) {
+                localCaster.enqueue({injected, now_us});
+            });
+        }
+    }
+    if (rawActive) {
+        rawServer.enqueue(queued);
+        if (betweenEpochs) {
+            rawInject.run(now_ms, [now_us](RtcmFramePool::Slot *injected) {
+                rawServer.enqueue({injected, now_us});
+            });
+        }
+    }
+    if (udpActive) {
+        udpOutput.enqueue(queued);
+        if (betweenEpochs) {
+            udpInject.run(now_ms, [now_us](RtcmFramePool::Slot *injected) {
+                udpOutput.enqueue({injected, now_us});
+            });
+        }
+    }
+    RtcmFramePool::release(frame);  // Drop the writer's reference
+}
+
+// Write out (or discard, if the caster went away or the frame is stale) every
+// frame queued for a caster
+void drainCasterQueue(Caster &caster) {
+    QueuedFrame queued;
+    while (caster.queue.pop(queued)) {
+        if (!caster.status.connected) {
+            releaseFromCaster(caster, queued.slot);
+            continue;
+        }
+        const uint32_t age_us = micros() - queued.enqueued_us;
+        if (age_us > maxFrameAge_us) {
+            caster.staleDrops++;
+            releaseFromCaster(caster, queued.slot);
+            continue;
+        }
+
+        if (caster.pendingCount == 0) {
+            caster.pendingSince_us = queued.enqueued_us;
+        }
+        caster.pending[caster.pendingCount++] = queued;
+
+        if (!caster.coalesce || caster.pendingCount == CASTER_EPOCH_MAX_FRAMES ||
+            rtcmbuffer::is_epoch_end(frameData(queued.slot), queued.slot->len)) {
+            sendEpoch(caster);
         }
+    }
 
-        // Release mutex after all updates are done
-        xSemaphoreGive(statusMutex);
+    if (caster.epochEndFiltered.exchange(false) && caster.pendingCount > 0) {
+        sendEpoch(caster);
+    }
+    // Frames after the last MSM (or an epoch whose last MSM was lost) go out on the deadline
+    if (caster.pendingCount > 0 &&
+        (!caster.status.connected || (unsigned long)(micros() - caster.pendingSince_us) >= epochDeadline_us)) {
+        sendEpoch(caster);
     }
 }
 
-void SFE_UBLOX_GNSS::processRTCM(uint8_t incoming) {
+const NTRIPStatus &ntrip_caster_status(const int index) {
+    return casters[index].status;
+}
+
+CasterQueueStats ntrip_queue_stats(const int index) {
+    const Caster &caster = casters[index];
+    CasterQueueStats stats;
+    stats.drops = caster.queue.drop_count();
+    stats.staleDrops = caster.staleDrops;
+    stats.limitDrops = caster.limitDrops;
+    stats.burstFrames = caster.burstFrames;
+    stats.filterDrops = caster.filter.frames_dropped();
+    stats.filterBytesSaved = caster.filter.bytes_saved();
+    stats.reducedFrames = caster.reducedFrames;
+    stats.reducedBytesSaved = caster.reducedBytesSaved;
+    stats.highWater = caster.queue.high_water_mark();
+    stats.latencyAvg_us = caster.latencyAvg_us;
+    stats.latencyMax_us = caster.latencyMax_us;
+    stats.epochs = caster.epochs;
+    stats.segments = caster.segments;
+    stats.epochLatencyAvg_us = caster.epochLatencyAvg_us;
+    stats.epochLatencyMax_us = caster.epochLatencyMax_us;
+    stats.correctionAge = caster.correctionAge.summary();
+    return stats;
+}
+
+const rtcmbuffer::Stats &ntrip_rtcm_stats() {
+    return uartFramer.get_stats();
+}
+
+const RtcmTypeStats &ntrip_rtcm_type_stats() {
+    return uartFramer.get_type_stats();
+}
+
+const msm::StreamStats &ntrip_msm_stats() {
+    return msmStats;
+}
+
+AgeSummary ntrip_uart_age() {
+    return uartAge.summary();
+}
+
+// RTCM bytes handed over one at a time by the u-blox library, while it reads the
+// UART itself for a command or query, are only staged here. Framing happens in
+// bulk (memchr/memcpy/block CRC) instead of running the framer state machine per byte.
+static uint8_t rtcmStage[RTCM_STAGE_BUFFER_SIZE];
+static size_t rtcmStageLen = 0;
+
+void ntrip_flush_rtcm() {
+    if (rtcmStageLen == 0) {
+        return;
+    }
+    // Note: lastRtcmData_ms is updated in CasterSink only for forwarded messages
+    uartFramer.process_bytes(rtcmStage, rtcmStageLen);
+    rtcmStageLen = 0;
+}
+
+void ntrip_process_rtcm(const uint8_t *data, const size_t len) {
     if (!ntrip_inited) {
         return;
     }
-    // Removed per-byte debug logging to reduce verbosity
-    // Note: lastRtcmData_ms is now updated in send_rtcm() only for forwarded messages
-    rtcmbuffer::process_byte(incoming,&send_rtcm);
+    ntrip_flush_rtcm();  // Bytes the library read come first
+    uartFramer.process_bytes(data, len);
 }
 
-void ntrip_handle_init() {
-    // Create mutex for thread-safe status access
-    statusMutex = xSemaphoreCreateMutex();
-    if (statusMutex == NULL) {
-        error("Failed to create NTRIP status mutex");
+void SFE_UBLOX_GNSS::processRTCM(uint8_t incoming) {
+    if (!ntrip_inited) {
         return;
     }
+    rtcmStage[rtcmStageLen++] = incoming;
+    if (rtcmStageLen == sizeof(rtcmStage)) {
+        ntrip_flush_rtcm();
+    }
+}
 
+void ntrip_handle_init() {
     // Initialize timers to current time
     unsigned long currentTime = millis();
-    lastHealthCheck_ms = currentTime;  // Prevent immediate health check
+    for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+        casters[i].number = i + 1;
+        casters[i].coalesce = settings[casterKey("coalesce", i + 1)].as<bool>();
+        casters[i].reduceMsm = settings[casterKey("reduceMsm", i + 1)].as<bool>();
+        const String filter = settings[casterKey("filter", i + 1)].as<String>();
+        if (!casters[i].filter.parse(filter.c_str())) {
+            warningf("Caster %d - invalid message filter \"%s\", forwarding everything", i + 1, filter.c_str());
+        }
+        casters[i].lastHealthCheck_ms = currentTime;  // Prevent immediate health check
+    }
+    writeStallTimeout_ms = settings["stallTimeout"].as<unsigned long>();
     // Set lastRtcmData_ms far in the past so RTCM check will fail until real data arrives
     // Using ULONG_MAX causes overflow to look like ~4.2 billion ms ago
     lastRtcmData_ms = currentTime - maxTimeBeforeHangup_ms - 1000;
 
-    rtcmbuffer::init();
-    xTaskCreate(NTRIPTask, "NTRIPTask",
-                NTRIP_TASK_STACK, // Stack size from defines.h
-                nullptr, // Task parameters
-                NTRIP_TASK_PRIORITY, // Task priority
-                nullptr // Task handle
-    );
+    // Pool slots for the outputs that can run, settings changes restart the device
+    int enabledCasters = 0;
+    for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+        if (settings[casterKey("enableCaster", i + 1)].as<bool>()) {
+            enabledCasters++;
+        }
+    }
+    const int lanServers = (settings["localCaster"].as<bool>() ? 1 : 0) + (settings["tcpServer"].as<bool>() ? 1 : 0);
+    const size_t poolSlots = frame_pool_budget::slots_for(enabledCasters, lanServers, settings["udpOutput"].as<bool>());
+    const size_t allocated = framePool.begin(poolSlots);
+    if (allocated < poolSlots) {
+        errorf("RTCM frame pool - only %u of %u slots allocated, outputs will drop frames",
+            (unsigned)allocated, (unsigned)poolSlots);
+    } else {
+        debugf("RTCM frame pool - %u slots, %u bytes", (unsigned)allocated, (unsigned)(allocated * sizeof(RtcmFramePool::Slot)));
+    }
+
+    // Firmware-generated messages and their per-output intervals (settings arpRate<n>, infoRate<n>,
+    // localArpRate, ...)
+    rtcm_inject_init(framePool);
+    for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+        casters[i].inject.interval_ms[(int)InjectedMessage::ARP] = settings[casterKey("arpRate", i + 1)].as<uint32_t>() * 1000;
+        casters[i].inject.interval_ms[(int)InjectedMessage::ANTENNA] = settings[casterKey("infoRate", i + 1)].as<uint32_t>() * 1000;
+    }
+    localInject.interval_ms[(int)InjectedMessage::ARP] = settings["localArpRate"].as<uint32_t>() * 1000;
+    rawInject.interval_ms[(int)InjectedMessage::ARP] = settings["tcpArpRate"].as<uint32_t>() * 1000;
+    udpInject.interval_ms[(int)InjectedMessage::ARP] = settings["udpArpRate"].as<uint32_t>() * 1000;
+    localInject.interval_ms[(int)InjectedMessage::ANTENNA] = settings["localInfoRate"].as<uint32_t>() * 1000;
+    rawInject.interval_ms[(int)InjectedMessage::ANTENNA] = settings["tcpInfoRate"].as<uint32_t>() * 1000;
+    udpInject.interval_ms[(int)InjectedMessage::ANTENNA] = settings["udpInfoRate"].as<uint32_t>() * 1000;
+    // Synthesised station messages also stand in for the receiver's in the handshake burst
+    for (int i = 0; i < (int)InjectedMessage::COUNT; i++) {
+        RtcmFramePool::Slot *injected = injected_frame((InjectedMessage)i);
+        if (injected == nullptr) {
+            continue;
+        }
+        const int index = stationFrameIndex(rtcmbuffer::get_rtcm_message_type(frameData(injected) + 3));
+        if (index >= 0) {
+            RtcmFramePool::retain(injected);
+            stationFrames[index] = injected;
+        }
+    }
+
+    uartFramer.reset();
+    uartSlot = framePool.acquire();
+    if (uartSlot == nullptr) {
+        error("RTCM frame pool - no slot for the framer, RTCM output disabled");
+        return;
+    }
+    uartFramer.set_buffer(frameData(uartSlot));
+    // One sender task per enabled caster, settings changes restart the device
+    for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+        if (!settings[casterKey("enableCaster", casters[i].number)].as<bool>()) {
+            continue;
+        }
+        char taskName[16];
+        snprintf(taskName, sizeof(taskName), "NTRIPTask%d", casters[i].number);
+        xTaskCreate(casterTask, taskName,
+                    NTRIP_TASK_STACK, // Stack size from defines.h
+                    &casters[i], // Task parameters
+                    NTRIP_TASK_PRIORITY, // Task priority
+                    &casters[i].task // Task handle, notified when frames are queued
+        );
+    }
     ntrip_inited = true;
 }
 
-[[noreturn]] void NTRIPTask(void *pvParameter) {
+[[noreturn]] void casterTask(void *pvParameter) {
+    Caster &caster = *static_cast<Caster *>(pvParameter);
     for (;;) {
         // Handle NTRIP communications
-        handleNTRIP();
-        delay(1);
+        handleCaster(caster);
+        drainCasterQueue(caster);
+        // Sleep until the UART task queues a frame, poll quickly while handshaking
+        // and wake up for the deadline of a pending epoch
+        const bool handshaking = caster.state == CasterState::CONNECTING || caster.state == CasterState::REQUEST_SENT;
+        unsigned long wait_ms = handshaking ? handshakePollInterval_ms : idleWakeInterval_ms;
+        if (caster.pendingCount > 0) {
+            const unsigned long waited_us = micros() - caster.pendingSince_us;
+            const unsigned long left_ms = waited_us >= epochDeadline_us ? 1 : (epochDeadline_us - waited_us) / 1000 + 1;
+            wait_ms = min(wait_ms, left_ms);
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
     }
 }
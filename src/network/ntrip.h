@@ -3,26 +3,85 @@
 #include <Arduino.h>
 #include "hardware/gps.h"
 #include "WebServer_ESP32_SC_W6100.hpp"
+#include "rtcmbuffer.h"
+#include "msm.h"
+#include "correction_age.h"
+
+enum class NTRIPError {
+    NONE,
+    CONNECTION_FAILED,
+    TIMEOUT,
+    INVALID_RESPONSE,
+    INVALID_CONFIG,
+    AUTH_FAILED,
+    RTCM_TIMEOUT,
+    SURVEY_IN_ACTIVE,
+    BUFFER_OVERFLOW,
+    WRITE_FAILED,
+    WRITE_STALLED
+};
+
+// Text for an error, "" for NONE
+const char *getErrorMessage(NTRIPError error);
 
 // Structure to track NTRIP connection status
 struct NTRIPStatus {
     bool connected;
     uint32_t bytesSent;
-    String lastError;
+    NTRIPError lastError;  // A single word, so the web task can read it while the caster task sets it
     int reconnectAttempts;
     unsigned long connectionOpenedAt;
     int protocolVersion;  // Added to track protocol version per connection
+    unsigned long lastHandshake_ms;  // Connect start to streaming, last successful connection
+    uint32_t writeStalls;            // Connections dropped because a write hit the stall threshold
+    unsigned long slowestWrite_ms;   // Longest single write
+    unsigned long lastRecovery_ms;   // Write failure to streaming again, last failover
+    unsigned long maxRecovery_ms;
+    unsigned long backoff_ms;        // Delay between connection attempts, grows with reconnectAttempts
+    unsigned long nextAttempt_ms;    // millis() of the next attempt while disconnected, 0 if none is scheduled
 };
 
 void ntrip_handle_init();
+// Frame RTCM bytes staged by processRTCM() while the library read the UART itself
+void ntrip_flush_rtcm();
+// Frame RTCM bytes read from the GNSS UART (whole frames or parts of them, in order)
+void ntrip_process_rtcm(const uint8_t *data, size_t len);
+// Framing counters of the GNSS UART stream
+const rtcmbuffer::Stats &ntrip_rtcm_stats();
+// Per-constellation MSM header counts and epoch completeness of the GNSS UART stream
+const msm::StreamStats &ntrip_msm_stats();
+// Per-message-type counters of the GNSS UART stream, see rtcm_type_stats.h
+const RtcmTypeStats &ntrip_rtcm_type_stats();
+// Age of the MSM epochs from the GNSS UART when framed, see correction_age.h
+AgeSummary ntrip_uart_age();
+
+// Counters of the frame queue between the GNSS UART task and one caster
+struct CasterQueueStats {
+    uint32_t drops;          // Frames dropped because the queue was full
+    uint32_t staleDrops;     // Frames discarded because they queued too long
+    uint32_t limitDrops;     // Frames not queued because the caster held its share of the frame pool
+    uint32_t burstFrames;    // Cached station frames (1005/1006/1033/1230) sent after handshakes
+    uint32_t filterDrops;       // Frames the message filter held back
+    uint32_t filterBytesSaved;  // Their bytes
+    uint32_t reducedFrames;     // MSM7 frames sent as MSM4
+    uint32_t reducedBytesSaved;
+    uint32_t highWater;      // Deepest queue fill level seen
+    uint32_t latencyAvg_us;  // Enqueue-to-send latency, moving average
+    uint32_t latencyMax_us;
+    uint32_t epochs;              // Writes sent, one per epoch when coalescing
+    uint32_t segments;            // TCP segments for those writes (estimate)
+    uint32_t epochLatencyAvg_us;  // Epoch complete to written, moving average
+    uint32_t epochLatencyMax_us;
+    AgeSummary correctionAge;     // MSM epoch time to written, see correction_age.h
+};
+
+// Caster output slots are indexed 0..NTRIP_CASTER_COUNT-1 (settings key suffix index+1)
+const NTRIPStatus &ntrip_caster_status(int index);
+CasterQueueStats ntrip_queue_stats(int index);
 
 // Function declarations
 bool stopNTRIP();
 bool startNTRIP();
-bool stopNTRIP(WiFiClient &client, bool isPrimary);
-
-// External status variables
-extern NTRIPStatus NtripPrimaryStatus;
-extern NTRIPStatus NtripSecondaryStatus;
+bool stopNTRIP(int index);
 
 extern  size_t write_count;
\ No newline at end of file
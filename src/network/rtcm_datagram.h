@@ -0,0 +1,62 @@
+//
+// Datagram format of the UDP RTCM output.
+//
+// Every datagram is an 8 byte header followed by one or more complete RTCM
+// frames:
+//   0  'R' 'T'   magic
+//   2  version   VERSION
+//   3  flags     FLAG_EPOCH_END on the last datagram of an epoch
+//   4  sequence  uint32 big endian, +1 per datagram
+// Receivers detect loss from gaps in the sequence. Frames are never split
+// across datagrams, so every datagram that arrives is usable on its own.
+//
+
+#ifndef RTCM_DATAGRAM_H
+#define RTCM_DATAGRAM_H
+#include <stdint.h>
+#include <stddef.h>
+
+namespace rtcm_datagram {
+
+constexpr size_t HEADER_LEN = 8;
+constexpr uint8_t VERSION = 1;
+constexpr uint8_t FLAG_EPOCH_END = 0x01;
+// Largest datagram that isn't fragmented on Ethernet (1500 - IP - UDP header)
+constexpr size_t MAX_DATAGRAM = 1472;
+
+struct Header {
+    uint8_t version;
+    uint8_t flags;
+    uint32_t sequence;
+};
+
+inline void encode_header(uint8_t *out, const uint32_t sequence, const uint8_t flags) {
+    out[0] = 'R';
+    out[1] = 'T';
+    out[2] = VERSION;
+    out[3] = flags;
+    out[4] = sequence >> 24;
+    out[5] = sequence >> 16;
+    out[6] = sequence >> 8;
+    out[7] = sequence;
+}
+
+// False if data is too short or not an RTCM datagram
+inline bool decode_header(const uint8_t *data, const size_t len, Header &header) {
+    if (len < HEADER_LEN || data[0] != 'R' || data[1] != 'T') {
+        return false;
+    }
+    header.version = data[2];
+    header.flags = data[3];
+    header.sequence = ((uint32_t)data[4] << 24) | ((uint32_t)data[5] << 16) | ((uint32_t)data[6] << 8) | data[7];
+    return true;
+}
+
+// Datagrams lost between two consecutively received sequence numbers, across wrap-around
+inline uint32_t lost_between(const uint32_t previous, const uint32_t current) {
+    return current - previous - 1;
+}
+
+}
+
+#endif //RTCM_DATAGRAM_H
@@ -0,0 +1,92 @@
+#include "rtcm_encoder.h"
+#include <string.h>
+#include "crc24q.h"
+
+namespace rtcm_encoder {
+
+void BitWriter::put(const uint64_t value, int bits) {
+    // Up to a byte at a time: the rest of the current byte, then whole bytes
+    while (bits > 0) {
+        const int space = 8 - (bit & 7);
+        const int take = bits < space ? bits : space;
+        const uint8_t chunk = (value >> (bits - take)) & ((1u << take) - 1);
+        buffer[bit >> 3] |= chunk << (space - take);
+        bit += take;
+        bits -= take;
+    }
+}
+
+void BitWriter::put_signed(const int64_t value, const int bits) {
+    put((uint64_t)value & ((1ULL << bits) - 1), bits);
+}
+
+size_t finish_frame(uint8_t *out, const size_t payload_len) {
+    out[0] = 0xD3;
+    out[1] = (payload_len >> 8) & 0x03;
+    out[2] = payload_len & 0xFF;
+    const uint32_t crc = crc24q::compute(out, 3 + payload_len);
+    out[3 + payload_len] = crc >> 16;
+    out[4 + payload_len] = crc >> 8;
+    out[5 + payload_len] = crc;
+    return payload_len + FRAME_OVERHEAD;
+}
+
+// Fields shared by 1005 and 1006
+static void put_arp(BitWriter &bits, const int msg_type, const StationPosition &position) {
+    bits.put(msg_type, 12);                     // DF002
+    bits.put(position.station_id, 12);          // DF003
+    bits.put(0, 6);                             // DF021 ITRF realization year, not given
+    bits.put(position.gps, 1);                  // DF022
+    bits.put(position.glonass, 1);              // DF023
+    bits.put(position.galileo, 1);              // DF024
+    bits.put(0, 1);                             // DF141 physical reference station
+    bits.put_signed(position.ecef_x, 38);       // DF025
+    bits.put(0, 1);                             // DF142 single receiver oscillator, not asserted
+    bits.put(0, 1);                             // DF001 reserved
+    bits.put_signed(position.ecef_y, 38);       // DF026
+    bits.put(0, 2);                             // DF364 quarter cycle indicator, unknown
+    bits.put_signed(position.ecef_z, 38);       // DF027
+}
+
+size_t encode_1005(const StationPosition &position, uint8_t *out) {
+    memset(out, 0, MSG_1005_LEN);
+    BitWriter bits(out + 3);
+    put_arp(bits, 1005, position);
+    return finish_frame(out, bits.bits_written() / 8);
+}
+
+size_t encode_1006(const StationPosition &position, uint8_t *out) {
+    memset(out, 0, MSG_1006_LEN);
+    BitWriter bits(out + 3);
+    put_arp(bits, 1006, position);
+    bits.put(position.antenna_height, 16);      // DF028
+    return finish_frame(out, bits.bits_written() / 8);
+}
+
+// Character counter followed by the characters
+static void put_string(BitWriter &bits, const char *text) {
+    size_t len = strlen(text);
+    if (len > MAX_DESCRIPTOR_LEN) {
+        len = MAX_DESCRIPTOR_LEN;
+    }
+    bits.put(len, 8);
+    for (size_t i = 0; i < len; i++) {
+        bits.put((uint8_t)text[i], 8);
+    }
+}
+
+size_t encode_1033(const ReceiverDescriptor &descriptor, uint8_t *out) {
+    memset(out, 0, MSG_1033_MAX_LEN);
+    BitWriter bits(out + 3);
+    bits.put(1033, 12);                             // DF002
+    bits.put(descriptor.station_id, 12);            // DF003
+    put_string(bits, descriptor.antenna_descriptor);  // DF029, DF030
+    bits.put(descriptor.antenna_setup_id, 8);       // DF031
+    put_string(bits, descriptor.antenna_serial);    // DF032, DF033
+    put_string(bits, descriptor.receiver_type);     // DF227, DF228
+    put_string(bits, descriptor.receiver_firmware); // DF229, DF230
+    put_string(bits, descriptor.receiver_serial);   // DF231, DF232
+    return finish_frame(out, bits.bits_written() / 8);
+}
+
+}
@@ -0,0 +1,72 @@
+//
+// Encoders for the RTCM 3.x station messages the firmware generates itself.
+//
+// Each encoder writes a complete frame (preamble, length, payload, CRC24Q) so
+// the result can be queued to the outputs like any frame from the receiver.
+// They run once when the settings are loaded, not per send.
+//
+
+#ifndef RTCM_ENCODER_H
+#define RTCM_ENCODER_H
+#include <stdint.h>
+#include <stddef.h>
+
+namespace rtcm_encoder {
+
+// Preamble + length (3) and CRC (3) around the payload
+constexpr size_t FRAME_OVERHEAD = 6;
+constexpr size_t MSG_1005_LEN = FRAME_OVERHEAD + 19;
+constexpr size_t MSG_1006_LEN = FRAME_OVERHEAD + 21;
+// 1033 strings are at most 31 characters, longer ones are truncated
+constexpr size_t MAX_DESCRIPTOR_LEN = 31;
+constexpr size_t MSG_1033_MAX_LEN = FRAME_OVERHEAD + 9 + 5 * MAX_DESCRIPTOR_LEN;
+
+// MSB-first bit packer over a zeroed buffer
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t *buffer) : buffer(buffer), bit(0) {}
+
+    void put(uint64_t value, int bits);
+    // Two's complement, bits wide
+    void put_signed(int64_t value, int bits);
+    size_t bits_written() const { return bit; }
+
+private:
+    uint8_t *buffer;
+    size_t bit;
+};
+
+// Stationary antenna reference point (DF003, DF022-DF028)
+struct StationPosition {
+    uint16_t station_id;      // 0-4095
+    int64_t ecef_x;           // 0.1 mm, same unit as the ecefX/Y/Z settings
+    int64_t ecef_y;
+    int64_t ecef_z;
+    uint16_t antenna_height;  // 0.1 mm above the marker, 1006 only
+    bool gps;                 // Constellations the station serves
+    bool glonass;
+    bool galileo;
+};
+
+// Antenna and receiver descriptor (DF029-DF033, DF227-DF232), empty strings allowed
+struct ReceiverDescriptor {
+    uint16_t station_id;
+    const char *antenna_descriptor;  // IGS name, e.g. "TRM59800.00     NONE"
+    uint8_t antenna_setup_id;
+    const char *antenna_serial;
+    const char *receiver_type;
+    const char *receiver_firmware;
+    const char *receiver_serial;
+};
+
+// out must hold MSG_1005_LEN / MSG_1006_LEN / MSG_1033_MAX_LEN bytes; returns the frame length
+size_t encode_1005(const StationPosition &position, uint8_t *out);
+size_t encode_1006(const StationPosition &position, uint8_t *out);
+size_t encode_1033(const ReceiverDescriptor &descriptor, uint8_t *out);
+
+// Write preamble, length and CRC around payload_len bytes at out + 3
+size_t finish_frame(uint8_t *out, size_t payload_len);
+
+}
+
+#endif //RTCM_ENCODER_H
@@ -0,0 +1,155 @@
+#include "rtcm_filter.h"
+#include <stdlib.h>
+#include <string.h>
+#include "rtcmbuffer.h"
+
+void RtcmFilter::clear() {
+    memset(table, ALLOW, sizeof(table));
+    ruleCount = FIRST_DECIMATE;
+    window = 0;
+    msmStream = false;
+    framesDropped = 0;
+    bytesSaved = 0;
+}
+
+// Parse a whole decimal number, false on anything else
+static bool parse_number(const char *text, const size_t len, long &value) {
+    if (len == 0 || len > 9) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (text[i] - '0');
+    }
+    return true;
+}
+
+bool RtcmFilter::set_target(const char *target, const size_t len, const uint8_t rule) {
+    if (len == 1 && target[0] == '*') {
+        memset(table, rule, sizeof(table));
+        return true;
+    }
+    if (len >= 3 && strncmp(target, "msm", 3) == 0) {
+        long sub_type = 0;
+        if (len > 3 && (!parse_number(target + 3, len - 3, sub_type) || sub_type < 1 || sub_type > 7)) {
+            return false;
+        }
+        // GPS 107x .. NavIC 113x
+        for (int msg_type = 1071; msg_type <= 1137; msg_type++) {
+            if (rtcmbuffer::is_msm(msg_type) && (sub_type == 0 || msg_type % 10 == sub_type)) {
+                table[rtcmbuffer::type_index(msg_type)] = rule;
+            }
+        }
+        return true;
+    }
+
+    long first;
+    long last;
+    const char *dash = static_cast<const char *>(memchr(target, '-', len));
+    if (dash == nullptr) {
+        if (!parse_number(target, len, first)) {
+            return false;
+        }
+        last = first;
+    } else if (!parse_number(target, dash - target, first) ||
+               !parse_number(dash + 1, len - (dash - target) - 1, last) || last < first) {
+        return false;
+    }
+    // Only types with their own entry, the shared one is reachable through "*" only
+    const int shared = rtcmbuffer::TYPE_TABLE_SIZE - 1;
+    const int firstIndex = rtcmbuffer::type_index(first);
+    const int lastIndex = rtcmbuffer::type_index(last);
+    if (firstIndex == shared || lastIndex == shared || lastIndex - firstIndex != last - first) {
+        return false;
+    }
+    memset(&table[firstIndex], rule, last - first + 1);
+    return true;
+}
+
+bool RtcmFilter::parse(const char *spec) {
+    clear();
+    const char *entry = spec;
+    while (*entry != '\0') {
+        const char *end = strchr(entry, ',');
+        if (end == nullptr) {
+            end = entry + strlen(entry);
+        }
+        const char *equals = static_cast<const char *>(memchr(entry, '=', end - entry));
+        if (equals == nullptr) {
+            clear();
+            return false;
+        }
+
+        const char *action = equals + 1;
+        const size_t actionLen = end - action;
+        uint8_t rule;
+        long interval_ms;
+        if (actionLen == 5 && strncmp(action, "allow", 5) == 0) {
+            rule = ALLOW;
+        } else if (actionLen == 4 && strncmp(action, "deny", 4) == 0) {
+            rule = DENY;
+        } else if (parse_number(action, actionLen, interval_ms) && interval_ms > 0 && ruleCount < MAX_RULES) {
+            rule = ruleCount++;
+            rules[rule].interval_ms = interval_ms;
+            rules[rule].due_ms = 0;
+            rules[rule].window = 0;
+            rules[rule].started = false;
+            rules[rule].passed = false;
+        } else {
+            clear();
+            return false;
+        }
+
+        if (!set_target(entry, equals - entry, rule)) {
+            clear();
+            return false;
+        }
+        entry = *end == ',' ? end + 1 : end;
+    }
+    return true;
+}
+
+void RtcmFilter::restart() {
+    for (int i = FIRST_DECIMATE; i < ruleCount; i++) {
+        rules[i].started = false;
+    }
+}
+
+bool RtcmFilter::decimate(Decimation &rule, const uint32_t now_ms) {
+    // The rest of an epoch follows the decision made on its first frame
+    if (msmStream && rule.started && rule.window == window) {
+        return rule.passed;
+    }
+
+    const int32_t late_ms = (int32_t)(now_ms - rule.due_ms);
+    const bool passed = !rule.started || late_ms > -(int32_t)(rule.interval_ms / DECIMATE_SLACK_DIV);
+    if (passed) {
+        // Stay on the schedule unless the stream paused for longer than an interval
+        rule.due_ms = (rule.started && late_ms < (int32_t)rule.interval_ms) ? rule.due_ms + rule.interval_ms
+                                                                            : now_ms + rule.interval_ms;
+        rule.started = true;
+    }
+    rule.window = window;
+    rule.passed = passed;
+    return passed;
+}
+
+bool RtcmFilter::pass(const uint8_t *frame, const int len, const uint32_t now_ms) {
+    const int msg_type = rtcmbuffer::get_rtcm_message_type(&frame[3]);
+    const bool msm = rtcmbuffer::is_msm(msg_type);
+    msmStream |= msm;
+    const uint8_t rule = table[rtcmbuffer::type_index(msg_type)];
+    const bool passed = rule == ALLOW || (rule != DENY && decimate(rules[rule], now_ms));
+
+    if (msm && rtcmbuffer::is_epoch_end(frame, len)) {
+        window++;
+    }
+    if (!passed) {
+        framesDropped++;
+        bytesSaved += len;
+    }
+    return passed;
+}
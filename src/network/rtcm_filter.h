@@ -0,0 +1,82 @@
+//
+// Per-output RTCM message filter: allow, deny or decimate each message type.
+//
+// The rules come from a settings string, comma separated and applied in order,
+// so later rules override earlier ones:
+//
+//   msm7=5000,1005=60000,1230=deny
+//
+// A target is a message type ("1005"), a range ("1071-1077"), "msm1" .. "msm7"
+// (that MSM of every constellation), "msm" (all MSM) or "*" (every type).
+// The action is "allow", "deny" or a minimum interval in ms (decimate).
+// Types without a rule are allowed.
+//
+// The decision is one lookup in a type-indexed table. Each decimating rule
+// passes one epoch's worth of its types per interval: all MSM frames of a
+// passing epoch go out together, and the interval runs on a fixed schedule so
+// arrival jitter doesn't skip an epoch. Not thread safe: one task decides,
+// other tasks may only read the counters.
+//
+
+#ifndef RTCM_FILTER_H
+#define RTCM_FILTER_H
+#include <stdint.h>
+#include <stddef.h>
+#include "rtcmbuffer.h"
+
+class RtcmFilter {
+public:
+    static constexpr int MAX_RULES = 16;  // Decimating rules plus the shared allow/deny
+
+    RtcmFilter() { clear(); }
+
+    // Allow everything
+    void clear();
+    // Replace the rules. On a syntax error or too many rules everything is
+    // allowed and false is returned.
+    bool parse(const char *spec);
+
+    // Decide for one CRC-checked frame at now_ms and count what is held back.
+    // Call for every frame of the stream, the epoch tracking needs them all.
+    bool pass(const uint8_t *frame, int len, uint32_t now_ms);
+    // Forget the epoch and decimation schedule, keep the rules and counters.
+    // Call before the first pass() after frames went by unseen (an output
+    // that was disconnected), so the next frame starts a new schedule instead
+    // of following a decision made for an epoch that ended meanwhile.
+    void restart();
+    // True if the type is always dropped (for frames the stream didn't carry,
+    // e.g. the cached station messages)
+    bool denies(int msg_type) const { return table[rtcmbuffer::type_index(msg_type)] == DENY; }
+
+    uint32_t frames_dropped() const { return framesDropped; }
+    uint32_t bytes_saved() const { return bytesSaved; }
+
+private:
+    // Rule numbers in table, decimating rules follow the two fixed ones
+    static constexpr uint8_t ALLOW = 0;
+    static constexpr uint8_t DENY = 1;
+    static constexpr uint8_t FIRST_DECIMATE = 2;
+    // A frame less than interval / DECIMATE_SLACK_DIV early still counts as on time
+    static constexpr uint32_t DECIMATE_SLACK_DIV = 10;
+
+    struct Decimation {
+        uint32_t interval_ms;
+        uint32_t due_ms;
+        uint32_t window;  // Epoch the last decision was made in
+        bool started;
+        bool passed;
+    };
+
+    bool set_target(const char *target, size_t len, uint8_t rule);
+    bool decimate(Decimation &rule, uint32_t now_ms);
+
+    uint8_t table[rtcmbuffer::TYPE_TABLE_SIZE];  // Rule number per message type, see rtcmbuffer::type_index()
+    Decimation rules[MAX_RULES];
+    int ruleCount;
+    uint32_t window;   // MSM epochs seen, advanced on each epoch end
+    bool msmStream;    // Epoch windows only hold decisions once the stream carries MSM
+    uint32_t framesDropped;
+    uint32_t bytesSaved;
+};
+
+#endif //RTCM_FILTER_H
@@ -0,0 +1,79 @@
+#include <core/defines.h>
+#include <Arduino.h>
+#include "rtcm_inject.h"
+#include "rtcm_encoder.h"
+#include "utils/log.h"
+#include "utils/settings.h"
+
+static RtcmFramePool::Slot *injectedFrames[(int)InjectedMessage::COUNT] = {};
+
+bool arp_synth_enabled() {
+    return settings["arpSynth"].as<bool>() &&
+           (settings["ecefX"].as<int64_t>() != 0 || settings["ecefY"].as<int64_t>() != 0 ||
+            settings["ecefZ"].as<int64_t>() != 0);
+}
+
+bool descriptor_enabled() {
+    return !settings["antDescriptor"].as<String>().isEmpty() || !settings["rcvType"].as<String>().isEmpty() ||
+           !settings["rcvFirmware"].as<String>().isEmpty();
+}
+
+// Take a slot for good and finish it like a framed receiver frame
+static RtcmFramePool::Slot *storeFrame(RtcmFramePool &pool, const uint8_t *frame, const size_t len) {
+    RtcmFramePool::Slot *slot = pool.acquire();
+    if (slot == nullptr) {
+        return nullptr;
+    }
+    memcpy(frameData(slot), frame, len);
+    slot->len = len;
+    chunk_frame::encode_chunk(frameData(slot), len);
+    return slot;
+}
+
+void rtcm_inject_init(RtcmFramePool &pool) {
+    if (arp_synth_enabled()) {
+        rtcm_encoder::StationPosition position;
+        position.station_id = settings["stationId"].as<uint16_t>();
+        position.ecef_x = settings["ecefX"].as<int64_t>();
+        position.ecef_y = settings["ecefY"].as<int64_t>();
+        position.ecef_z = settings["ecefZ"].as<int64_t>();
+        position.antenna_height = settings["antHeight"].as<uint16_t>();
+        position.gps = true;  // Observations come from the F9P's GPS/GLONASS/Galileo/BeiDou MSM
+        position.glonass = true;
+        position.galileo = true;
+
+        uint8_t frame[rtcm_encoder::MSG_1006_LEN];
+        const size_t len = position.antenna_height != 0 ? rtcm_encoder::encode_1006(position, frame)
+                                                        : rtcm_encoder::encode_1005(position, frame);
+        injectedFrames[(int)InjectedMessage::ARP] = storeFrame(pool, frame, len);
+        infof("RTCM %d synthesised for station %u", position.antenna_height != 0 ? 1006 : 1005, position.station_id);
+    }
+
+    if (descriptor_enabled()) {
+        // Keep the strings alive while encoding, the descriptor only points at them
+        const String antenna = settings["antDescriptor"].as<String>();
+        const String antennaSerial = settings["antSerial"].as<String>();
+        const String receiver = settings["rcvType"].as<String>();
+        const String firmware = settings["rcvFirmware"].as<String>();
+        const String receiverSerial = settings["rcvSerial"].as<String>();
+
+        rtcm_encoder::ReceiverDescriptor descriptor;
+        descriptor.station_id = settings["stationId"].as<uint16_t>();
+        descriptor.antenna_descriptor = antenna.c_str();
+        descriptor.antenna_setup_id = settings["antSetupId"].as<uint8_t>();
+        descriptor.antenna_serial = antennaSerial.c_str();
+        descriptor.receiver_type = receiver.c_str();
+        descriptor.receiver_firmware = firmware.c_str();
+        descriptor.receiver_serial = receiverSerial.c_str();
+
+        uint8_t frame[rtcm_encoder::MSG_1033_MAX_LEN];
+        const size_t len = rtcm_encoder::encode_1033(descriptor, frame);
+        injectedFrames[(int)InjectedMessage::ANTENNA] = storeFrame(pool, frame, len);
+        infof("RTCM 1033 synthesised: antenna \"%s\", receiver \"%s\" %s", antenna.c_str(), receiver.c_str(),
+              firmware.c_str());
+    }
+}
+
+RtcmFramePool::Slot *injected_frame(const InjectedMessage message) {
+    return injectedFrames[(int)message];
+}
@@ -0,0 +1,50 @@
+//
+// RTCM frames generated by the firmware and the schedule that interleaves them
+// into each output.
+//
+// The frames are encoded once from the settings into pool slots that are never
+// released. Injecting one into an output is a queue push of that slot, the same
+// as for a frame from the receiver.
+//
+
+#pragma once
+
+#include <stdint.h>
+#include "rtcm_output.h"
+
+enum class InjectedMessage {
+    ARP,    // 1005, or 1006 with an antenna height, from ecefX/Y/Z
+    ANTENNA,  // 1033 antenna and receiver descriptors
+    COUNT
+};
+
+// True if the settings ask for a synthesised ARP and hold a position for it
+bool arp_synth_enabled();
+// True if any 1033 descriptor string is set
+bool descriptor_enabled();
+
+// Encode the enabled messages from the settings, once at startup
+void rtcm_inject_init(RtcmFramePool &pool);
+// nullptr if the message isn't enabled
+RtcmFramePool::Slot *injected_frame(InjectedMessage message);
+
+// Injection intervals of one output, run by the GNSS UART task only
+struct InjectSchedule {
+    InjectSchedule() : interval_ms(), last_ms() {}
+
+    uint32_t interval_ms[(int)InjectedMessage::COUNT];  // 0: never
+    unsigned long last_ms[(int)InjectedMessage::COUNT];
+
+    // Call emit(slot) for every enabled message whose interval has passed
+    template <typename Emit>
+    void run(const unsigned long now_ms, Emit emit) {
+        for (int i = 0; i < (int)InjectedMessage::COUNT; i++) {
+            RtcmFramePool::Slot *frame = injected_frame((InjectedMessage)i);
+            if (frame == nullptr || interval_ms[i] == 0 || now_ms - last_ms[i] < interval_ms[i]) {
+                continue;
+            }
+            last_ms[i] = now_ms;
+            emit(frame);
+        }
+    }
+};
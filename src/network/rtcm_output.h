@@ -0,0 +1,53 @@
+//
+// Frame types shared by the RTCM outputs (casters, LAN servers).
+//
+// Frames are assembled by the framer directly in pool slots. A finished slot is
+// queued by pointer to every active output and goes back to the pool once the
+// last output has written it, so a frame is never copied per consumer.
+//
+// Slot layout: [chunk header headroom][RTCM frame][chunk trailer]. The NTRIP 2.0
+// chunk is encoded once when the frame is finished; v2 outputs send the chunk
+// view, v1 and raw outputs the frame itself (see chunk_frame.h).
+//
+
+#pragma once
+
+#include <core/defines.h>
+#include "rtcmbuffer.h"
+#include "frame_pool.h"
+#include "chunk_frame.h"
+
+// Most pool slots each holder keeps at once. The pool is allocated at startup
+// with room for the holders the settings enable (slots_for()), at most
+// RTCM_FRAME_POOL_SLOTS with everything on; each output checks that maximum
+// against the sum next to the code that enforces its own share.
+namespace frame_pool_budget {
+constexpr int CASTER = CASTER_MAX_HELD_FRAMES;  // Counted per caster, frames beyond are dropped for it
+constexpr int LAN_SERVER = LOCAL_CASTER_INPUT_DEPTH + LOCAL_CLIENT_QUEUE_DEPTH;  // Clients hold the same frames
+constexpr int UDP = LOCAL_CASTER_INPUT_DEPTH + CASTER_EPOCH_MAX_FRAMES;
+constexpr int STATION_CACHE = 4;  // Latest 1005/1006/1033/1230
+constexpr int INJECTED = 2;       // Firmware-generated messages, held for good
+constexpr int FRAMER = 2;         // The slot being filled and its successor during a hand-over
+constexpr int CONVERSION = 1;     // An MSM4 re-encoding until the casters took it
+// Holders that are there whatever the settings
+constexpr int FIXED = STATION_CACHE + INJECTED + FRAMER + CONVERSION;
+
+constexpr int slots_for(const int casters, const int lan_servers, const bool udp) {
+    return casters * CASTER + lan_servers * LAN_SERVER + (udp ? UDP : 0) + FIXED;
+}
+
+constexpr int TOTAL = slots_for(NTRIP_CASTER_COUNT, 2, true);
+}
+
+typedef FramePool<RTCM_FRAME_POOL_SLOTS,
+                  chunk_frame::CHUNK_HEADROOM + rtcmbuffer::MAX_FRAME_LEN + chunk_frame::CHUNK_TAILROOM> RtcmFramePool;
+
+inline uint8_t *frameData(RtcmFramePool::Slot *slot) {
+    return slot->data + chunk_frame::CHUNK_HEADROOM;
+}
+
+// A frame reference in an output queue; the queue entry owns one reference
+struct QueuedFrame {
+    RtcmFramePool::Slot *slot;
+    unsigned long enqueued_us;  // For enqueue-to-send latency
+};
@@ -0,0 +1,366 @@
+#include <core/defines.h>
+#include <Arduino.h>
+#include "rtcm_server.h"
+#include "hardware/gps.h"
+#include "utils/log.h"
+#include "utils/settings.h"
+#include <lwip/sockets.h>
+
+// Configuration
+constexpr int acceptPollInterval_ms = 50;  // Accept and request polling without traffic
+constexpr int writeRetryInterval_ms = 5;   // Retry rate while a client's socket is full
+constexpr int throughputInterval_ms = 1000;
+
+// Frames held by a server: a full input ring plus a full queue of the slowest client, the
+// other clients' queues hold the newest of the same frames. A client that would exceed its
+// queue is disconnected, so this share is never exceeded.
+static_assert(frame_pool_budget::LAN_SERVER >= LOCAL_CASTER_INPUT_DEPTH + LOCAL_CLIENT_QUEUE_DEPTH,
+              "LAN server share of the frame pool too small for its queues");
+static_assert(RTCM_FRAME_POOL_SLOTS >= frame_pool_budget::TOTAL, "Frame pool smaller than the shares of all holders");
+
+RtcmServer localCaster(RtcmServer::Protocol::NTRIP, "Local caster", "LocalCasterTask");
+RtcmServer rawServer(RtcmServer::Protocol::RAW, "TCP server", "TcpServerTask");
+
+RtcmServer::RtcmServer(const Protocol protocol, const char *label, const char *taskName)
+    : protocol(protocol), label(label), taskName(taskName), listenPort(0), mountpoint(""), task(nullptr),
+      statsLock(nullptr), streamingClients(0), dropped(0), lastRate_ms(0) {}
+
+void RtcmServer::begin(const uint16_t port, const char *mount) {
+    listenPort = port;
+    snprintf(mountpoint, sizeof(mountpoint), "%s", mount);
+    statsLock = xSemaphoreCreateMutex();
+    server.begin(port);
+    server.setNoDelay(true);
+    xTaskCreate(serverTask, taskName,
+                LOCAL_CASTER_TASK_STACK, // Stack size from defines.h
+                this, // Task parameters
+                LOCAL_CASTER_TASK_PRIORITY, // Task priority
+                &task // Task handle, notified when frames are queued
+    );
+}
+
+void RtcmServer::enqueue(const QueuedFrame &frame) {
+    RtcmFramePool::retain(frame.slot);
+    if (!input.push(frame)) {
+        RtcmFramePool::release(frame.slot);  // Server task is behind, counted by the ring
+        return;
+    }
+    xTaskNotifyGive(task);
+}
+
+bool RtcmServer::clientStats(const int index, ClientStats &stats) const {
+    if (statsLock == nullptr) {
+        return false;  // Never started
+    }
+    xSemaphoreTake(statsLock, portMAX_DELAY);
+    const ClientSnapshot snapshot = snapshots[index];
+    xSemaphoreGive(statsLock);
+    if (!snapshot.streaming) {
+        return false;
+    }
+    stats = snapshot.stats;
+    stats.connected_ms = millis() - snapshot.streaming_ms;
+    return true;
+}
+
+// Server task only, once per pass
+void RtcmServer::publishStats() {
+    if (statsLock == nullptr) {
+        return;  // Out of memory at begin(), clientStats() reports nothing
+    }
+    xSemaphoreTake(statsLock, portMAX_DELAY);
+    for (int i = 0; i < LOCAL_CASTER_MAX_CLIENTS; i++) {
+        const Client &client = clients[i];
+        ClientSnapshot &snapshot = snapshots[i];
+        snapshot.streaming = client.state == ClientState::STREAMING;
+        if (!snapshot.streaming) {
+            continue;
+        }
+        snapshot.streaming_ms = client.streaming_ms;
+        snapshot.stats.ip = client.ip;
+        snapshot.stats.version = client.version;
+        snapshot.stats.bytesSent = client.bytesSent;
+        snapshot.stats.throughput = client.throughput;
+        snapshot.stats.queueDepth = client.queue.size();
+        snapshot.stats.lag_us = client.lag_us;
+        snapshot.stats.lagMax_us = client.lagMax_us;
+    }
+    xSemaphoreGive(statsLock);
+}
+
+size_t RtcmServer::memoryPerClient() {
+    return sizeof(Client) + sizeof(ClientSnapshot);
+}
+
+void RtcmServer::acceptClients() {
+    while (server.hasClient()) {
+        WiFiClient incoming = server.available();
+        Client *free = nullptr;
+        for (Client &client : clients) {
+            if (client.state == ClientState::FREE) {
+                free = &client;
+                break;
+            }
+        }
+        if (free == nullptr) {
+            warningf("%s - Rejecting %s, all %d client slots in use", label,
+                     incoming.remoteIP().toString().c_str(), LOCAL_CASTER_MAX_CLIENTS);
+            incoming.stop();
+            continue;
+        }
+
+        free->socket = incoming;
+        free->socket.setNoDelay(true);
+        free->ip = incoming.remoteIP();
+        free->version = 1;
+        free->requestLen = 0;
+        free->accepted_ms = millis();
+        free->offset = 0;
+        free->bytesSent = 0;
+        free->rateBytes = 0;
+        free->throughput = 0;
+        free->lag_us = 0;
+        free->lagMax_us = 0;
+        free->state = ClientState::REQUEST;
+        if (protocol == Protocol::RAW) {
+            free->version = 0;
+            startStream(*free);
+        }
+    }
+}
+
+// Frames are queued for the client from the next fan-out on
+void RtcmServer::startStream(Client &client) {
+    client.state = ClientState::STREAMING;
+    client.streaming_ms = millis();
+    streamingClients.fetch_add(1, std::memory_order_relaxed);
+    if (protocol == Protocol::RAW) {
+        infof("%s - %s connected", label, client.ip.toString().c_str());
+    } else {
+        infof("%s - %s streaming /%s (NTRIP %d.0)", label, client.ip.toString().c_str(), mountpoint, client.version);
+    }
+}
+
+// Collect the request; answer the mountpoint with a stream, anything else with the sourcetable
+void RtcmServer::readRequest(Client &client) {
+    while (client.socket.available() && client.requestLen < (int)sizeof(client.request) - 1) {
+        client.request[client.requestLen++] = client.socket.read();
+    }
+    client.request[client.requestLen] = '\0';
+
+    if (strstr(client.request, "\r\n\r\n") == nullptr) {
+        if (client.requestLen == (int)sizeof(client.request) - 1) {
+            warningf("%s - Request from %s too long", label, client.ip.toString().c_str());
+            closeClient(client);
+        } else if (millis() - client.accepted_ms > LOCAL_CASTER_REQUEST_TIMEOUT_MS) {
+            warningf("%s - Request from %s timed out", label, client.ip.toString().c_str());
+            closeClient(client);
+        }
+        return;  // Wait for the rest of the request
+    }
+
+    if (strncmp(client.request, "GET /", 5) != 0) {
+        client.socket.print("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n");
+        closeClient(client);
+        return;
+    }
+    client.version = strstr(client.request, "Ntrip-Version: Ntrip/2.0") != nullptr ? 2 : 1;
+
+    const char *path = client.request + 5;
+    const size_t pathLen = strcspn(path, " \r\n");
+    if (pathLen != strlen(mountpoint) || strncmp(path, mountpoint, pathLen) != 0) {
+        sendSourcetable(client);
+        closeClient(client);
+        return;
+    }
+
+    char response[320];
+    int responseLen;
+    if (client.version == 2) {
+        responseLen = snprintf(response, sizeof(response),
+            "HTTP/1.1 200 OK\r\n"
+            "Ntrip-Version: Ntrip/2.0\r\n"
+            "Server: NTRIP %s/App Version %s\r\n"
+            "Content-Type: gnss/data\r\n"
+            "Transfer-Encoding: chunked\r\n"
+            "Cache-Control: no-store, no-cache, max-age=0\r\n"
+            "Connection: close\r\n\r\n",
+            settings["ntrip_sName"].as<const char*>(), FIRMWARE_VERSION);
+    } else {
+        responseLen = snprintf(response, sizeof(response), "ICY 200 OK\r\n\r\n");
+    }
+    client.socket.write((const uint8_t *)response, responseLen);
+    startStream(client);
+}
+
+void RtcmServer::sendSourcetable(Client &client) {
+    char body[256];
+    const int bodyLen = snprintf(body, sizeof(body),
+        "STR;%s;%s;RTCM 3.3;;2;GNSS;LAN;;%.4f;%.4f;0;0;NTRIP %s;none;N;N;0;\r\n"
+        "ENDSOURCETABLE\r\n",
+        mountpoint, mountpoint, currentGPSStatus.latitude, currentGPSStatus.longitude,
+        settings["ntrip_sName"].as<const char*>());
+
+    char header[256];
+    int headerLen;
+    if (client.version == 2) {
+        headerLen = snprintf(header, sizeof(header),
+            "HTTP/1.1 200 OK\r\n"
+            "Ntrip-Version: Ntrip/2.0\r\n"
+            "Server: NTRIP %s/App Version %s\r\n"
+            "Content-Type: gnss/sourcetable\r\n"
+            "Content-Length: %d\r\n"
+            "Connection: close\r\n\r\n",
+            settings["ntrip_sName"].as<const char*>(), FIRMWARE_VERSION, bodyLen);
+    } else {
+        headerLen = snprintf(header, sizeof(header),
+            "SOURCETABLE 200 OK\r\n"
+            "Server: NTRIP %s/App Version %s\r\n"
+            "Content-Type: text/plain\r\n"
+            "Content-Length: %d\r\n\r\n",
+            settings["ntrip_sName"].as<const char*>(), FIRMWARE_VERSION, bodyLen);
+    }
+    client.socket.write((const uint8_t *)header, headerLen);
+    client.socket.write((const uint8_t *)body, bodyLen);
+    debugf("%s - Sent sourcetable to %s", label, client.ip.toString().c_str());
+}
+
+// Queue a frame reference for every streaming client. A client whose queue is
+// full can't keep up with the stream and is disconnected rather than stalling.
+void RtcmServer::fanOut(const QueuedFrame &frame) {
+    for (Client &client : clients) {
+        if (client.state != ClientState::STREAMING) {
+            continue;
+        }
+        RtcmFramePool::retain(frame.slot);
+        if (!client.queue.push(frame)) {
+            RtcmFramePool::release(frame.slot);
+            warningf("%s - Dropping %s, more than %d frames behind", label,
+                     client.ip.toString().c_str(), LOCAL_CLIENT_QUEUE_DEPTH);
+            dropped++;
+            closeClient(client);
+        }
+    }
+    RtcmFramePool::release(frame.slot);  // Drop the input ring's reference
+}
+
+// Write as much of the client's queue as the socket takes without blocking.
+// Returns true if frames are left for a later retry.
+bool RtcmServer::writeClient(Client &client) {
+    // Rovers may upload NMEA GGA, it isn't used
+    uint8_t discard[64];
+    while (client.socket.available()) {
+        client.socket.read(discard, sizeof(discard));
+    }
+    if (!client.socket.connected()) {
+        infof("%s - %s disconnected", label, client.ip.toString().c_str());
+        closeClient(client);
+        return false;
+    }
+
+    QueuedFrame head;
+    while (client.queue.peek(head)) {
+        const uint8_t *frame = frameData(head.slot);
+        const size_t frameLen = head.slot->len;
+        const uint8_t *data = frame;
+        size_t total = frameLen;
+        if (client.version == 2) {
+            data = chunk_frame::chunk_start(frame, frameLen);
+            total = chunk_frame::chunk_len(frameLen);
+        }
+
+        const ssize_t written = send(client.socket.fd(), data + client.offset, total - client.offset, MSG_DONTWAIT);
+        if (written < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;  // Socket buffer full, retry on the next tick
+            }
+            infof("%s - %s disconnected (errno %d)", label, client.ip.toString().c_str(), errno);
+            closeClient(client);
+            return false;
+        }
+        client.offset += written;
+        if (client.offset < total) {
+            break;
+        }
+
+        client.offset = 0;
+        client.bytesSent += frameLen;
+        client.lag_us = micros() - head.enqueued_us;
+        client.queue.pop(head);
+        RtcmFramePool::release(head.slot);
+    }
+
+    if (client.queue.peek(head)) {
+        client.lag_us = micros() - head.enqueued_us;
+    }
+    if (client.lag_us > client.lagMax_us) {
+        client.lagMax_us = client.lag_us;
+    }
+    return client.queue.size() > 0;
+}
+
+void RtcmServer::updateThroughput() {
+    const unsigned long now = millis();
+    const unsigned long elapsed_ms = now - lastRate_ms;
+    if (elapsed_ms < throughputInterval_ms) {
+        return;
+    }
+    lastRate_ms = now;
+    for (Client &client : clients) {
+        if (client.state != ClientState::STREAMING) {
+            continue;
+        }
+        client.throughput = (uint64_t)(client.bytesSent - client.rateBytes) * 1000 / elapsed_ms;
+        client.rateBytes = client.bytesSent;
+    }
+}
+
+void RtcmServer::closeClient(Client &client) {
+    QueuedFrame queued;
+    while (client.queue.pop(queued)) {
+        RtcmFramePool::release(queued.slot);
+    }
+    client.socket.stop();
+    if (client.state == ClientState::STREAMING) {
+        streamingClients.fetch_sub(1, std::memory_order_relaxed);
+    }
+    client.offset = 0;
+    client.state = ClientState::FREE;
+}
+
+[[noreturn]] void RtcmServer::serverTask(void *pvParameter) {
+    RtcmServer &self = *static_cast<RtcmServer *>(pvParameter);
+    for (;;) {
+        self.acceptClients();
+
+        QueuedFrame frame;
+        while (self.input.pop(frame)) {
+            self.fanOut(frame);
+        }
+
+        self.updateThroughput();
+
+        bool backlog = false;
+        for (Client &client : self.clients) {
+            if (client.state == ClientState::REQUEST) {
+                self.readRequest(client);
+            } else if (client.state == ClientState::STREAMING) {
+                backlog |= self.writeClient(client);
+            }
+        }
+        self.publishStats();
+        // Sleep until the UART task queues a frame, retry soon while a socket is full
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(backlog ? writeRetryInterval_ms : acceptPollInterval_ms));
+    }
+}
+
+void local_caster_init() {
+    if (settings["localCaster"].as<bool>()) {
+        localCaster.begin(settings["localCasterPort"].as<uint16_t>(), settings["localMount"].as<const char*>());
+        infof("Local caster - Listening on port %u, mountpoint /%s", localCaster.port(), localCaster.mount());
+    }
+    if (settings["tcpServer"].as<bool>()) {
+        rawServer.begin(settings["tcpServerPort"].as<uint16_t>());
+        infof("TCP server - Listening on port %u", rawServer.port());
+    }
+}
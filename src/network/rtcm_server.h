@@ -0,0 +1,137 @@
+//
+// RTCM servers for rovers on the local network.
+//
+// In NTRIP mode rovers connect to us (GET /<mount>, NTRIP 1.0 or 2.0) instead
+// of going through an internet caster. In raw mode (like str2str's tcpsvr) a
+// client gets the plain RTCM stream as soon as it connects, without a
+// handshake. Every frame from the UART framer is fanned out
+// by reference from the shared frame pool into a small queue per client. The
+// server task writes those queues with non-blocking sends; a client whose
+// queue overflows is too slow for the stream and gets disconnected, so one bad
+// link never holds frames back for the others or for the upstream casters.
+//
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <WebServer_ESP32_SC_W6100.hpp>
+#include <core/defines.h>
+#include "rtcm_output.h"
+#include "spsc_ring.h"
+
+class RtcmServer {
+public:
+    enum class Protocol {
+        NTRIP,  // HTTP request for a mountpoint, sourcetable otherwise
+        RAW     // RTCM from the first byte
+    };
+
+    // Snapshot of one connected client for /status
+    struct ClientStats {
+        IPAddress ip;
+        int version;          // NTRIP version of the request, 0 for raw clients
+        uint32_t bytesSent;
+        uint32_t throughput;  // Bytes/s over the last second
+        unsigned long connected_ms;  // Time since the stream started
+        uint32_t queueDepth;  // Frames waiting for this client
+        uint32_t lag_us;      // Age of the oldest unsent frame
+        uint32_t lagMax_us;
+    };
+
+    RtcmServer(Protocol protocol, const char *label, const char *taskName);
+
+    // Start listening and the server task, mount is only used in NTRIP mode
+    void begin(uint16_t port, const char *mount = "");
+    bool enabled() const { return task != nullptr; }
+    uint16_t port() const { return listenPort; }
+    const char *mount() const { return mountpoint; }
+
+    // True while at least one client streams, checked per frame by the UART task
+    bool active() const { return streamingClients.load(std::memory_order_relaxed) > 0; }
+    // GNSS UART task only: queue a finished frame, takes its own reference
+    void enqueue(const QueuedFrame &frame);
+
+    int clientCount() const { return streamingClients.load(std::memory_order_relaxed); }
+    // Any task: the state of a client slot as of the server task's last pass, false if it
+    // wasn't streaming
+    bool clientStats(int index, ClientStats &stats) const;
+    uint32_t droppedClients() const { return dropped; }
+    // RAM per client slot; frames are shared with the other outputs and not included
+    static size_t memoryPerClient();
+
+private:
+    enum class ClientState {
+        FREE,
+        REQUEST,    // Accepted, reading the HTTP request
+        STREAMING
+    };
+
+    typedef SpscRing<QueuedFrame, LOCAL_CLIENT_QUEUE_DEPTH> ClientQueue;
+
+    struct Client {
+        Client() : state(ClientState::FREE), version(1), requestLen(0), accepted_ms(0), streaming_ms(0),
+                   offset(0), bytesSent(0), rateBytes(0), throughput(0), lag_us(0), lagMax_us(0) {}
+
+        ClientState state;
+        WiFiClient socket;
+        IPAddress ip;
+        int version;
+        char request[LOCAL_CASTER_REQUEST_SIZE];
+        int requestLen;
+        unsigned long accepted_ms;
+        unsigned long streaming_ms;
+        ClientQueue queue;           // Filled and drained by the server task only
+        size_t offset;               // Bytes of the queue head already written
+        uint32_t bytesSent;
+        uint32_t rateBytes;          // bytesSent at the start of the current second
+        uint32_t throughput;
+        uint32_t lag_us;
+        uint32_t lagMax_us;
+    };
+
+    // What clientStats() reports for a slot, copied from its Client under statsLock
+    struct ClientSnapshot {
+        ClientSnapshot() : streaming(false), streaming_ms(0), stats() {}
+
+        bool streaming;
+        unsigned long streaming_ms;
+        ClientStats stats;  // connected_ms is filled in when read
+    };
+
+    [[noreturn]] static void serverTask(void *pvParameter);
+    void acceptClients();
+    void readRequest(Client &client);
+    void sendSourcetable(Client &client);
+    void startStream(Client &client);
+    void updateThroughput();
+    void fanOut(const QueuedFrame &frame);
+    bool writeClient(Client &client);
+    void closeClient(Client &client);
+    void publishStats();
+
+    const Protocol protocol;
+    const char *label;     // Log prefix
+    const char *taskName;
+    WiFiServer server;
+    uint16_t listenPort;
+    char mountpoint[32];
+    TaskHandle_t task;
+    SpscRing<QueuedFrame, LOCAL_CASTER_INPUT_DEPTH> input;  // UART task -> server task
+    Client clients[LOCAL_CASTER_MAX_CLIENTS];
+    // Client fields are only touched by the server task. Other tasks read the snapshots, a
+    // mutex rather than a sequence counter so a higher-priority reader can't spin on a
+    // preempted server task.
+    SemaphoreHandle_t statsLock;
+    ClientSnapshot snapshots[LOCAL_CASTER_MAX_CLIENTS];
+    std::atomic<int> streamingClients;
+    uint32_t dropped;  // Clients disconnected for falling behind
+    unsigned long lastRate_ms;
+};
+
+extern RtcmServer localCaster;
+extern RtcmServer rawServer;
+
+// Start the LAN outputs enabled in the settings (localCaster, localCasterPort, localMount;
+// tcpServer, tcpServerPort)
+void local_caster_init();
@@ -0,0 +1,18 @@
+//
+// Message type -> table index, shared by the per-type tables of the framer's
+// type statistics and the per-output message filter.
+//
+
+#ifndef RTCM_TYPE_INDEX_H
+#define RTCM_TYPE_INDEX_H
+
+namespace rtcmbuffer
+{
+// Message types 1001-1299 and 4001-4095 have a table index each, every other type shares the last
+constexpr int STANDARD_TYPES = 299;
+constexpr int PROPRIETARY_TYPES = 95;
+constexpr int TYPE_TABLE_SIZE = STANDARD_TYPES + PROPRIETARY_TYPES + 1;
+int type_index(int msg_type);  // Implemented in rtcmbuffer.cpp
+}
+
+#endif //RTCM_TYPE_INDEX_H
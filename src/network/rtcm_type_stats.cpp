@@ -0,0 +1,62 @@
+#include "rtcm_type_stats.h"
+#include <math.h>
+#include <string.h>
+#include "rtcmbuffer.h"
+
+void RtcmTypeStats::clear() {
+    memset(slots, 0, sizeof(slots));
+    memset(entries, 0, sizeof(entries));
+    count = 0;
+    untracked = 0;
+}
+
+RtcmTypeStats::Entry *RtcmTypeStats::find(const int msg_type, const bool create) {
+    const int index = rtcmbuffer::type_index(msg_type);
+    if (slots[index] != 0) {
+        return &entries[slots[index] - 1];
+    }
+    if (!create || count == MAX_TYPES) {
+        return nullptr;
+    }
+    Entry &entry = entries[count];
+    entry.msg_type = index == rtcmbuffer::TYPE_TABLE_SIZE - 1 ? 0 : msg_type;
+    slots[index] = count + 1;
+    count = count + 1;
+    return &entry;
+}
+
+void RtcmTypeStats::add(const int msg_type, const int len, const uint32_t now_ms) {
+    Entry *entry = find(msg_type, true);
+    if (entry == nullptr) {
+        untracked++;
+        return;
+    }
+    if (entry->frames > 0) {
+        const uint32_t interval_ms = now_ms - entry->last_ms;
+        entry->last_interval_ms = interval_ms;
+        if (entry->frames == 1 || interval_ms < entry->min_interval_ms) {
+            entry->min_interval_ms = interval_ms;
+        }
+        if (interval_ms > entry->max_interval_ms) {
+            entry->max_interval_ms = interval_ms;
+        }
+        // Welford: n intervals so far, including this one
+        const uint32_t n = entry->frames;
+        const double delta = interval_ms - entry->mean;
+        entry->mean += delta / n;
+        entry->m2 += delta * (interval_ms - entry->mean);
+        entry->interval_ms = entry->mean;
+        entry->jitter_ms = n > 1 ? sqrt(entry->m2 / (n - 1)) : 0.0;
+    }
+    entry->frames++;
+    entry->bytes += len;
+    entry->last_ms = now_ms;
+}
+
+void RtcmTypeStats::crc_error(const int msg_type) {
+    // The type of a corrupt frame may itself be corrupt, don't let it take an entry
+    Entry *entry = find(msg_type, false);
+    if (entry != nullptr) {
+        entry->crc_errors++;
+    }
+}
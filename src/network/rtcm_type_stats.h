@@ -0,0 +1,66 @@
+//
+// Per-message-type statistics of an RTCM stream: frames, bytes, CRC errors,
+// when a type was last seen and how regular its interval is.
+//
+// A type-indexed table (rtcmbuffer::type_index) points to one of MAX_TYPES
+// entries, handed out in first-seen order, so each frame is one lookup. The
+// mean interval and its jitter (standard deviation) use Welford's method over
+// every interval since boot. A receiver that stops sending a type shows up in
+// the time since it was last seen, a drifting schedule in the mean interval.
+//
+// Written by one task; other tasks may read. Entries are filled in before they
+// are counted in size(), and interval_ms / jitter_ms are published as single
+// words so a reader never sees half an update.
+//
+
+#ifndef RTCM_TYPE_STATS_H
+#define RTCM_TYPE_STATS_H
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "rtcm_type_index.h"
+
+class RtcmTypeStats {
+public:
+    static constexpr int MAX_TYPES = 32;
+
+    struct Entry {
+        int msg_type;              // 0 for the entry shared by types outside 1001-1299 and 4001-4095
+        uint32_t frames;
+        uint32_t bytes;
+        uint32_t crc_errors;       // Frames of this type that failed the CRC check
+        uint32_t last_ms;          // When the latest frame arrived
+        uint32_t last_interval_ms;
+        uint32_t min_interval_ms;
+        uint32_t max_interval_ms;
+        float interval_ms;         // Mean interval
+        float jitter_ms;           // Standard deviation of the interval
+        double mean;               // Welford accumulators behind the two above
+        double m2;
+    };
+
+    RtcmTypeStats() { clear(); }
+
+    void clear();
+    // Account a CRC-checked frame of len bytes that arrived at now_ms
+    void add(int msg_type, int len, uint32_t now_ms);
+    // Account a frame whose header looked like msg_type but whose CRC didn't
+    // match, on the entry of a type already seen intact
+    void crc_error(int msg_type);
+
+    // Entries in first-seen order
+    int size() const { return count; }
+    const Entry &entry(const int i) const { return entries[i]; }
+    // Frames of further types once every entry is taken
+    uint32_t untracked_frames() const { return untracked; }
+
+private:
+    Entry *find(int msg_type, bool create);
+
+    uint8_t slots[rtcmbuffer::TYPE_TABLE_SIZE];  // Entry number + 1 per table index, 0 if none yet
+    Entry entries[MAX_TYPES];
+    std::atomic<int> count;
+    uint32_t untracked;
+};
+
+#endif //RTCM_TYPE_STATS_H
@@ -0,0 +1,164 @@
+#include <core/defines.h>
+#include <Arduino.h>
+#include "rtcm_udp.h"
+#include "rtcm_datagram.h"
+#include "utils/log.h"
+#include "utils/settings.h"
+#include <lwip/sockets.h>
+
+// Configuration
+constexpr int idleWakeInterval_ms = 100;                                       // Check the epoch deadline without RTCM
+constexpr unsigned long epochDeadline_us = CASTER_EPOCH_DEADLINE_MS * 1000UL;  // Send a coalesced epoch at the latest after this
+constexpr int multicastTtl = 1;                                                // Keep multicast on the site LAN
+
+static_assert(rtcm_datagram::HEADER_LEN + rtcmbuffer::MAX_FRAME_LEN <= rtcm_datagram::MAX_DATAGRAM,
+              "Every RTCM frame must fit a datagram on its own");
+// A full input ring plus one coalesced epoch
+static_assert(frame_pool_budget::UDP >= LOCAL_CASTER_INPUT_DEPTH + CASTER_EPOCH_MAX_FRAMES,
+              "UDP output share of the frame pool too small for its queue plus one epoch");
+static_assert(RTCM_FRAME_POOL_SLOTS >= frame_pool_budget::TOTAL, "Frame pool smaller than the shares of all holders");
+
+RtcmUdpOutput udpOutput;
+
+RtcmUdpOutput::RtcmUdpOutput()
+    : fd(-1), destination(""), destinationPort(0), coalesce(true), task(nullptr), pendingCount(0),
+      pendingSince_us(0), sequence(0), datagrams(0), frames(0), bytes(0), sendErrors(0) {}
+
+bool RtcmUdpOutput::begin(const char *host, const uint16_t port, const bool coalesceEpochs) {
+    struct sockaddr_in target;
+    memset(&target, 0, sizeof(target));
+    if (inet_aton(host, &target.sin_addr) == 0) {
+        errorf("UDP output - Invalid address %s", host);
+        return false;
+    }
+    target.sin_family = AF_INET;
+    target.sin_port = htons(port);
+
+    fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (fd < 0) {
+        errorf("UDP output - Socket creation failed (errno %d)", errno);
+        return false;
+    }
+    if (IN_MULTICAST(ntohl(target.sin_addr.s_addr))) {
+        const uint8_t ttl = multicastTtl;
+        setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    }
+    // A fixed destination keeps the per-datagram path down to one writev()
+    if (connect(fd, (struct sockaddr *)&target, sizeof(target)) < 0) {
+        errorf("UDP output - Connect to %s:%u failed (errno %d)", host, port, errno);
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    snprintf(destination, sizeof(destination), "%s", host);
+    destinationPort = port;
+    coalesce = coalesceEpochs;
+    sequence = esp_random();  // Receivers resync on the first datagram, not on 0
+    xTaskCreate(outputTask, "UdpOutputTask",
+                UDP_OUTPUT_TASK_STACK, // Stack size from defines.h
+                this, // Task parameters
+                UDP_OUTPUT_TASK_PRIORITY, // Task priority
+                &task // Task handle, notified when frames are queued
+    );
+    return true;
+}
+
+void RtcmUdpOutput::enqueue(const QueuedFrame &frame) {
+    RtcmFramePool::retain(frame.slot);
+    if (!input.push(frame)) {
+        RtcmFramePool::release(frame.slot);  // Output task is behind, counted by the ring
+        return;
+    }
+    xTaskNotifyGive(task);
+}
+
+RtcmUdpOutput::Stats RtcmUdpOutput::stats() const {
+    Stats stats;
+    stats.datagrams = datagrams;
+    stats.frames = frames;
+    stats.bytes = bytes;
+    stats.sendErrors = sendErrors;
+    stats.drops = input.drop_count();
+    stats.sequence = sequence;
+    return stats;
+}
+
+// Pack the pending frames into as few datagrams as fit the MTU, frames are
+// gathered straight from their pool slots behind the header
+void RtcmUdpOutput::sendPending() {
+    int first = 0;
+    while (first < pendingCount) {
+        uint8_t header[rtcm_datagram::HEADER_LEN];
+        struct iovec iov[1 + CASTER_EPOCH_MAX_FRAMES];
+        iov[0].iov_base = header;
+        iov[0].iov_len = sizeof(header);
+        size_t size = sizeof(header);
+
+        int last = first;
+        while (last < pendingCount && size + pending[last].slot->len <= rtcm_datagram::MAX_DATAGRAM) {
+            iov[1 + last - first].iov_base = frameData(pending[last].slot);
+            iov[1 + last - first].iov_len = pending[last].slot->len;
+            size += pending[last].slot->len;
+            last++;
+        }
+
+        RtcmFramePool::Slot *tail = pending[last - 1].slot;
+        const bool epochEnd = rtcmbuffer::is_epoch_end(frameData(tail), tail->len);
+        rtcm_datagram::encode_header(header, sequence++, epochEnd ? rtcm_datagram::FLAG_EPOCH_END : 0);
+
+        if (writev(fd, iov, 1 + last - first) < 0) {
+            sendErrors++;  // No buffer or no link; the sequence gap tells receivers
+        } else {
+            datagrams++;
+            bytes += size;
+        }
+        frames += last - first;
+        first = last;
+    }
+
+    for (int i = 0; i < pendingCount; i++) {
+        RtcmFramePool::release(pending[i].slot);
+    }
+    pendingCount = 0;
+}
+
+[[noreturn]] void RtcmUdpOutput::outputTask(void *pvParameter) {
+    RtcmUdpOutput &self = *static_cast<RtcmUdpOutput *>(pvParameter);
+    for (;;) {
+        QueuedFrame queued;
+        while (self.input.pop(queued)) {
+            if (self.pendingCount == 0) {
+                self.pendingSince_us = queued.enqueued_us;
+            }
+            self.pending[self.pendingCount++] = queued;
+            if (!self.coalesce || self.pendingCount == CASTER_EPOCH_MAX_FRAMES ||
+                rtcmbuffer::is_epoch_end(frameData(queued.slot), queued.slot->len)) {
+                self.sendPending();
+            }
+        }
+
+        unsigned long wait_ms = idleWakeInterval_ms;
+        if (self.pendingCount > 0) {
+            const unsigned long waited_us = micros() - self.pendingSince_us;
+            if (waited_us >= epochDeadline_us) {
+                self.sendPending();
+            } else {
+                wait_ms = min(wait_ms, (epochDeadline_us - waited_us) / 1000 + 1);
+            }
+        }
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait_ms));
+    }
+}
+
+void udp_output_init() {
+    if (!settings["udpOutput"].as<bool>()) {
+        return;
+    }
+    const char *host = settings["udpHost"].as<const char*>();
+    const uint16_t port = settings["udpPort"].as<uint16_t>();
+    if (udpOutput.begin(host, port, settings["udpCoalesce"].as<bool>())) {
+        infof("UDP output - Sending RTCM to %s:%u (%s)", host, port,
+              udpOutput.coalescing() ? "one datagram per epoch" : "one datagram per frame");
+    }
+}
@@ -0,0 +1,66 @@
+//
+// UDP RTCM output for many rovers on a site LAN.
+//
+// Frames are sent to one unicast or multicast address without any handshake
+// or per-receiver state, so the cost on the ESP32 doesn't grow with the number
+// of rovers. With coalescing on, a whole epoch goes out as one datagram (or as
+// few as the MTU allows); otherwise every frame is its own datagram. Each
+// datagram carries the sequence header from rtcm_datagram.h.
+//
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <core/defines.h>
+#include "rtcm_output.h"
+#include "spsc_ring.h"
+
+class RtcmUdpOutput {
+public:
+    struct Stats {
+        uint32_t datagrams;
+        uint32_t frames;
+        uint32_t bytes;       // Datagram payload including headers
+        uint32_t sendErrors;
+        uint32_t drops;       // Frames dropped because the output task fell behind
+        uint32_t sequence;    // Next sequence number
+    };
+
+    RtcmUdpOutput();
+
+    // Open the socket and start the output task. False if host isn't an IPv4 address.
+    bool begin(const char *host, uint16_t port, bool coalesce);
+    bool active() const { return task != nullptr; }
+    const char *host() const { return destination; }
+    uint16_t port() const { return destinationPort; }
+    bool coalescing() const { return coalesce; }
+
+    // GNSS UART task only: queue a finished frame, takes its own reference
+    void enqueue(const QueuedFrame &frame);
+    Stats stats() const;
+
+private:
+    [[noreturn]] static void outputTask(void *pvParameter);
+    void sendPending();
+
+    int fd;
+    char destination[40];
+    uint16_t destinationPort;
+    bool coalesce;
+    TaskHandle_t task;
+    SpscRing<QueuedFrame, LOCAL_CASTER_INPUT_DEPTH> input;  // UART task -> output task
+    QueuedFrame pending[CASTER_EPOCH_MAX_FRAMES];
+    int pendingCount;
+    unsigned long pendingSince_us;
+    uint32_t sequence;
+    uint32_t datagrams;
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t sendErrors;
+};
+
+extern RtcmUdpOutput udpOutput;
+
+// Start the UDP output if enabled in the settings (udpOutput, udpHost, udpPort, udpCoalesce)
+void udp_output_init();
@@ -5,18 +5,370 @@
 #ifndef RTCMBUFFER_H
 #define RTCMBUFFER_H
 #include <stdint.h>
-
+#include <stddef.h>
+#include <string.h>
+#include "crc24q.h"
+#include "rtcm_type_index.h"
+#include "rtcm_type_stats.h"
 
 namespace rtcmbuffer
 {
-void init();
-void process_byte(uint8_t byte, void (*forward_func)(const uint8_t *, int));
+// RTCM message max size: 3 header + 1023 payload + 3 CRC = 1029 bytes
+constexpr size_t MAX_FRAME_LEN = 1029;
+
+// Framing error and resync counters since the last reset()
+struct Stats {
+    uint32_t crc_errors;
+    uint32_t length_errors;     // Header errors (non-zero reserved bits, frame too long)
+    uint32_t bytes_skipped;     // Bytes dropped while resyncing to the next preamble
+    uint32_t frames_recovered;  // Valid frames found by rescanning buffered bytes after an error
+};
 
-// Exposed for testing
-int parse_rtcm_length(uint8_t *buf);
+int parse_rtcm_length(const uint8_t *buf);
 int get_rtcm_message_type(const uint8_t *payload);
+
+// MSM1-7 of any constellation (10x1-10x7, GPS 1071 .. NavIC 1137)
+bool is_msm(int msg_type);
+// True for the last MSM frame of an epoch (multiple message bit clear)
+bool is_epoch_end(const uint8_t *frame, int len);
+
+// Shared by all framers, implemented in rtcmbuffer.cpp
+bool should_forward(const uint8_t *frame, int len);
+void report_length_error();
+// frame holds the complete frame that failed the check
+void report_crc_error(const uint8_t *frame, uint32_t expected, uint32_t actual);
+// Account a CRC-checked frame in a framer's type statistics, stamped with the current time
+void count_frame(RtcmTypeStats &stats, const uint8_t *frame, int len);
 }
 
+// RTCM 3.x framer for one input stream (UART, TCP tap, replay file, ...).
+//
+// RTCM 3.x Message Format:
+// [0xD3] [Length-H] [Length-L] [Payload 0-1023 bytes] [CRC24-H] [CRC24-M] [CRC24-L]
+//  byte0   byte1      byte2      byte3...byte(N+2)      byte(N+3) byte(N+4) byte(N+5)
+//
+// Length Encoding: 10-bit value split across bytes 1-2
+//   byte1: [reserved(6)] [length(2 MSB)]
+//   byte2: [length(8 LSB)]
+//
+// CRC24: Computed over header + payload (bytes 0 to N+2), stored in bytes N+3 to N+5
+//
+// Every CRC-checked frame, forwarded or not, and every CRC failure of a type
+// already seen intact is counted in the instance's own RtcmTypeStats.
+//
+// MaxFrameLen caps the accepted frame size (header + payload + CRC); frames that
+// don't fit are treated as header errors. Sink is any callable taking
+// (const uint8_t *frame, int len); it is called with every valid frame that
+// passes rtcmbuffer::should_forward(). Passing a functor type lets the forward
+// call inline.
+//
+// Each instance holds its own state, so any number of streams can be framed at
+// once. An instance is not thread safe: feed it from one task only.
+//
+// Frames are assembled in a built-in buffer unless set_buffer() points the
+// framer at external storage (e.g. a FramePool slot), which lets the sink pass
+// the frame on by reference instead of copying it.
+template <size_t MaxFrameLen, typename Sink>
+class RtcmFramer {
+    static_assert(MaxFrameLen >= 6 && MaxFrameLen <= rtcmbuffer::MAX_FRAME_LEN,
+                  "MaxFrameLen must hold at least an empty frame and at most a spec-max frame");
+
+public:
+    explicit RtcmFramer(Sink sink = Sink()) : sink(sink), rtcm_buffer(own_buffer), handoff_len(0) {
+        reset();
+    }
+
+    // Assemble frames in `buffer` (at least MaxFrameLen bytes) from now on.
+    // Bytes buffered but not yet forwarded are carried over. Called from inside
+    // the sink, this hands the storage of the frame being forwarded to the sink:
+    // the framer won't touch the old buffer again.
+    void set_buffer(uint8_t *buffer) {
+        if (buffer == rtcm_buffer) {
+            return;
+        }
+        if (rtcm_index > handoff_len) {
+            memcpy(buffer + handoff_len, rtcm_buffer + handoff_len, rtcm_index - handoff_len);
+        }
+        rtcm_buffer = buffer;
+    }
+
+    // Drop any partial frame and clear the counters
+    void reset() {
+        reset_buffer();
+        resynced = false;
+        stats = rtcmbuffer::Stats();
+        type_stats.clear();
+    }
+
+    const rtcmbuffer::Stats &get_stats() const {
+        return stats;
+    }
+
+    // Written while framing, other tasks may read (see rtcm_type_stats.h)
+    const RtcmTypeStats &get_type_stats() const {
+        return type_stats;
+    }
+
+    // Bytewise state machine, keeps a running CRC:
+    // 1. IDLE (in_message=false): Wait for 0xD3 preamble byte
+    // 2. HEADER (rtcm_index<3): Collect 3 header bytes to parse length
+    // 3. PAYLOAD (rtcm_index>=3): Collect N payload bytes, update CRC24
+    // 4. CRC (rtcm_index==length+6): Verify CRC24, forward if valid
+    // 5. RESET: Return to IDLE, or resync() on a header/CRC error
+    void process_byte(uint8_t byte) {
+        // STATE 1: IDLE - Wait for 0xD3 preamble
+        if (!in_message) {
+            if (byte == 0xD3) {
+                in_message = true;
+                rtcm_index = 0;
+                running_crc = 0;
+                rtcm_buffer[rtcm_index++] = byte;
+            }
+            return;
+        }
+
+        // Store current byte
+        rtcm_buffer[rtcm_index] = byte;
+
+        // Update CRC for payload bytes only (not the last 3 CRC bytes)
+        if (rtcm_index >= 3 && rtcm_index < rtcm_length + 3) {
+            running_crc = crc24q::update(running_crc, byte);
+        }
+
+        rtcm_index++;
+
+        // STATE 2: HEADER COMPLETE (after 3 bytes) - Parse message length
+        if (rtcm_index == 3) {
+            rtcm_length = rtcmbuffer::parse_rtcm_length(rtcm_buffer);
+
+            if (!header_valid()) {
+                stats.length_errors++;
+                rtcmbuffer::report_length_error();
+                resync();
+                return;
+            }
+
+            // Initialize CRC with header bytes
+            running_crc = crc24q::update(0, rtcm_buffer, 3);
+        }
+
+        // STATE 3: MESSAGE COMPLETE - Verify CRC and forward
+        // Total message size: 3 (header) + N (payload) + 3 (CRC) = N+6 bytes
+        if (rtcm_index == rtcm_length + 6) {
+            const uint32_t expected_crc = stored_crc(rtcm_index);
+
+            if (running_crc == expected_crc) {
+                deliver(rtcm_index);
+            } else {
+                crc_error(expected_crc, running_crc);
+                resync();
+                return;
+            }
+
+            // STATE 4: RESET - Return to IDLE state
+            reset_buffer();
+        }
+    }
+
+    // Bulk variant of process_byte for whole reads.
+    //
+    // Same frame format, validation and resync as process_byte, but instead of
+    // one call and several branches per byte it:
+    // - skips inter-frame bytes with a single memchr() for the next 0xD3 preamble
+    // - copies header and payload runs straight into rtcm_buffer with memcpy()
+    // - runs CRC24Q once over the complete frame (slicing-by-8) instead of per byte
+    //
+    // A frame may be split across any number of calls. Don't mix process_byte and
+    // process_bytes on the same instance: only process_byte keeps running_crc current.
+    void process_bytes(const uint8_t *data, size_t len) {
+        while (len > 0) {
+            // IDLE - jump straight to the next preamble, drop everything before it
+            if (!in_message) {
+                const uint8_t *preamble = static_cast<const uint8_t *>(memchr(data, 0xD3, len));
+                if (preamble == nullptr) {
+                    return;
+                }
+                len -= preamble - data;
+                data = preamble;
+                in_message = true;
+                rtcm_index = 0;
+                rtcm_length = 0;
+            }
+
+            // HEADER - collect the 3 header bytes, then validate them once
+            if (rtcm_index < 3) {
+                size_t take = 3 - rtcm_index;
+                if (take > len) {
+                    take = len;
+                }
+                memcpy(&rtcm_buffer[rtcm_index], data, take);
+                rtcm_index += take;
+                data += take;
+                len -= take;
+                if (rtcm_index < 3) {
+                    return;  // Header continues in the next read
+                }
+
+                rtcm_length = rtcmbuffer::parse_rtcm_length(rtcm_buffer);
+                if (!header_valid()) {
+                    stats.length_errors++;
+                    rtcmbuffer::report_length_error();
+                    resync();
+                    continue;
+                }
+            }
+
+            // PAYLOAD + CRC - copy as much of the remaining frame as this read holds
+            const int frame_len = rtcm_length + 6;
+            size_t take = frame_len - rtcm_index;
+            if (take > len) {
+                take = len;
+            }
+            memcpy(&rtcm_buffer[rtcm_index], data, take);
+            rtcm_index += take;
+            data += take;
+            len -= take;
+            if (rtcm_index < frame_len) {
+                return;  // Frame continues in the next read
+            }
+
+            // COMPLETE - one CRC pass over header + payload
+            const uint32_t crc = crc24q::compute(rtcm_buffer, rtcm_length + 3);
+            const uint32_t expected_crc = stored_crc(frame_len);
+            if (crc == expected_crc) {
+                deliver(frame_len);
+                reset_buffer();
+            } else {
+                crc_error(expected_crc, crc);
+                resync();
+            }
+        }
+    }
+
+private:
+    Sink sink;
+    uint8_t own_buffer[MaxFrameLen];
+    uint8_t *rtcm_buffer;  // own_buffer or external storage, see set_buffer()
+    int handoff_len;       // Bytes of rtcm_buffer being forwarded, set during the sink call
+    int rtcm_index;
+    int rtcm_length;
+    bool in_message;
+    uint32_t running_crc;
+    bool resynced;  // Current frame was found by resync(), not by the live stream
+    rtcmbuffer::Stats stats;
+    RtcmTypeStats type_stats;
+
+    void reset_buffer() {
+        rtcm_index = 0;
+        rtcm_length = 0;
+        in_message = false;
+        running_crc = 0;
+        // No need to clear rtcm_buffer: bytes are only read back up to rtcm_index
+    }
+
+    // Header sanity check, needs rtcm_index >= 3.
+    // The 10-bit length can't exceed 1023 by construction, so the useful check is
+    // that the 6 reserved bits are zero - this rejects most false 0xD3 preambles
+    // inside payload data right after the header instead of after up to 1029 bytes.
+    bool header_valid() const {
+        return (rtcm_buffer[1] & 0xFC) == 0 && (size_t)rtcm_length + 6 <= MaxFrameLen;
+    }
+
+    uint32_t stored_crc(int frame_len) const {
+        return ((uint32_t)rtcm_buffer[frame_len - 3] << 16) |
+               ((uint32_t)rtcm_buffer[frame_len - 2] << 8) |
+                (uint32_t)rtcm_buffer[frame_len - 1];
+    }
+
+    // The frame at the start of rtcm_buffer failed its CRC check
+    void crc_error(uint32_t expected_crc, uint32_t actual_crc) {
+        stats.crc_errors++;
+        type_stats.crc_error(rtcmbuffer::get_rtcm_message_type(&rtcm_buffer[3]));
+        rtcmbuffer::report_crc_error(rtcm_buffer, expected_crc, actual_crc);
+    }
+
+    // Forward a complete, CRC-checked frame sitting at the start of rtcm_buffer
+    void deliver(int frame_len) {
+        if (resynced) {
+            stats.frames_recovered++;
+            resynced = false;
+        }
+        rtcmbuffer::count_frame(type_stats, rtcm_buffer, frame_len);  // Everything the receiver sent, forwarded or not
+        if (rtcmbuffer::should_forward(rtcm_buffer, frame_len)) {
+            handoff_len = frame_len;
+            sink(rtcm_buffer, frame_len);
+            handoff_len = 0;
+        }
+    }
+
+    // Lossless resynchronisation after a CRC or header error.
+    //
+    // The bytes buffered since the failed preamble may contain the start of real
+    // frames (e.g. the previous frame was truncated by a UART overrun and the next
+    // one was swallowed as its payload). Instead of discarding them, rescan them for
+    // the next 0xD3 and re-frame from there:
+    // - complete frames found in the buffered bytes are forwarded right away
+    // - a partial frame stays buffered and continues with the next input byte
+    // - bytes before the next candidate preamble are dropped and counted
+    void resync() {
+        int start = 1;  // rtcm_buffer[0] is the preamble that just failed
+        for (;;) {
+            const uint8_t *next = nullptr;
+            if (rtcm_index > start) {
+                next = static_cast<const uint8_t *>(memchr(&rtcm_buffer[start], 0xD3, rtcm_index - start));
+            }
+            if (next == nullptr) {
+                stats.bytes_skipped += rtcm_index;
+                reset_buffer();
+                return;
+            }
+
+            const int offset = next - rtcm_buffer;
+            stats.bytes_skipped += offset;
+            rtcm_index -= offset;
+            memmove(rtcm_buffer, next, rtcm_index);
+            in_message = true;
+            resynced = true;
+            start = 1;
+
+            if (rtcm_index < 3) {
+                rtcm_length = 0;
+                running_crc = 0;
+                return;  // Header continues with the next input byte
+            }
+
+            rtcm_length = rtcmbuffer::parse_rtcm_length(rtcm_buffer);
+            if (!header_valid()) {
+                stats.length_errors++;
+                continue;
+            }
+
+            const int frame_len = rtcm_length + 6;
+            if (rtcm_index < frame_len) {
+                // Partial frame, bring the bytewise running CRC up to date
+                const int crc_len = rtcm_index < rtcm_length + 3 ? rtcm_index : rtcm_length + 3;
+                running_crc = crc24q::compute(rtcm_buffer, crc_len);
+                return;
+            }
+
+            if (crc24q::compute(rtcm_buffer, rtcm_length + 3) != stored_crc(frame_len)) {
+                stats.crc_errors++;
+                continue;
+            }
+            deliver(frame_len);
+
+            // Bytes after the recovered frame haven't been framed yet
+            rtcm_index -= frame_len;
+            if (rtcm_index == 0) {
+                reset_buffer();
+                return;
+            }
+            memmove(rtcm_buffer, rtcm_buffer + frame_len, rtcm_index);
+            start = 0;
+        }
+    }
+};
+
 
 
 #endif //RTCMBUFFER_H
@@ -0,0 +1,89 @@
+//
+// Lock-free single-producer / single-consumer ring.
+//
+// push() is only ever called from one task and pop() from one other task; no
+// mutex or critical section is taken, so the producer (the GNSS UART task)
+// never blocks on the consumer. A full ring rejects the new item and counts it
+// as a drop. Capacity must be a power of two.
+//
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0), high_water(0), drops(0) {}
+
+    // Producer side. Returns false (and counts a drop) when the ring is full.
+    bool push(const T &item) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        const size_t t = tail.load(std::memory_order_acquire);
+        if (h - t == Capacity) {
+            drops.store(drops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (Capacity - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+
+        const uint32_t depth = h + 1 - t;
+        if (depth > high_water.load(std::memory_order_relaxed)) {
+            high_water.store(depth, std::memory_order_relaxed);
+        }
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T &item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        item = items[t & (Capacity - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Copies the oldest item without removing it, so a partly
+    // written frame stays queued until pop().
+    bool peek(T &item) const {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) {
+            return false;
+        }
+        item = items[t & (Capacity - 1)];
+        return true;
+    }
+
+    // Snapshot, exact only when called from the producer or consumer
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    uint32_t drop_count() const {
+        return drops.load(std::memory_order_relaxed);
+    }
+
+    // Deepest fill level seen since start
+    uint32_t high_water_mark() const {
+        return high_water.load(std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity() {
+        return Capacity;
+    }
+
+private:
+    T items[Capacity];
+    std::atomic<size_t> head;  // Next slot to write, producer only
+    std::atomic<size_t> tail;  // Next slot to read, consumer only
+    std::atomic<uint32_t> high_water;
+    std::atomic<uint32_t> drops;
+};
+
+#endif //SPSC_RING_H
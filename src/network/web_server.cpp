@@ -5,6 +5,10 @@
 #include "utils/settings.h"
 #include <http_parser.h>
 #include "ntrip.h"
+#include "rtcm_server.h"
+#include "rtcm_udp.h"
+#include "rtcm_inject.h"
+#include "rtcm_type_stats.h"
 #include "ethernet.h"
 #include "web_server.h"
 #include <Update.h>
@@ -14,6 +18,60 @@
 // HTTP Related
 WebServer server(80);
 
+// /status document: one entry per caster slot (17 members, backoff, queue, epochs, filter and
+// correctionAge objects, the uptime string), one per LAN client of either server (9 members and
+// the address string) and the fixed rest (GNSS, UART, RTCM, MSM per constellation, UDP output)
+constexpr size_t statusPerCaster = JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(17) + JSON_OBJECT_SIZE(2) +
+                                   JSON_OBJECT_SIZE(7) + JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(6) +
+                                   JSON_OBJECT_SIZE(5) + 32;
+constexpr size_t statusPerClient = JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(9) + 16;
+constexpr size_t statusFixed = 3840;
+constexpr size_t statusDocumentSize = statusFixed + NTRIP_CASTER_COUNT * statusPerCaster +
+                                      2 * LOCAL_CASTER_MAX_CLIENTS * statusPerClient;
+
+// Listener settings, clients and per-client counters of a LAN server
+static void addServerStatus(JsonObject out, const RtcmServer &rtcmServer)
+{
+    out["enabled"]         = rtcmServer.enabled();
+    out["port"]            = rtcmServer.port();
+    out["clients"]         = rtcmServer.clientCount();
+    out["droppedClients"]  = rtcmServer.droppedClients();
+    out["memoryPerClient"] = RtcmServer::memoryPerClient();
+    JsonArray clients = out.createNestedArray("clientList");
+    for (int i = 0; i < LOCAL_CASTER_MAX_CLIENTS; i++) {
+        RtcmServer::ClientStats clientStats;
+        if (!rtcmServer.clientStats(i, clientStats)) {
+            continue;
+        }
+        JsonObject client = clients.createNestedObject();
+        client["ip"]            = clientStats.ip.toString();
+        client["version"]       = clientStats.version;
+        client["connectedSec"]  = clientStats.connected_ms / 1000;
+        client["bytesSent"]     = clientStats.bytesSent;
+        client["bytesPerSec"]   = clientStats.throughput;
+        client["queueDepth"]    = clientStats.queueDepth;
+        client["lagMs"]         = clientStats.lag_us / 1000;
+        client["lagMaxMs"]      = clientStats.lagMax_us / 1000;
+    }
+}
+
+static void addProtocolStatus(JsonObject out, const GnssProtocolStats &protocol)
+{
+    out["bytes"]       = protocol.bytes;
+    out["frames"]      = protocol.frames;
+    out["bytesPerSec"] = protocol.bytesPerSec;
+}
+
+// Correction age percentiles in ms, see correction_age.h
+static void addAgeStatus(JsonObject out, const AgeSummary &age)
+{
+    out["p50Ms"]   = age.p50_ms;
+    out["p95Ms"]   = age.p95_ms;
+    out["p99Ms"]   = age.p99_ms;
+    out["maxMs"]   = age.max_ms;
+    out["samples"] = age.samples;
+}
+
 static void notFound()
 {
     debugf("Not found: %s", server.uri().c_str());
@@ -173,7 +231,7 @@ void initializeWebServer()
     server.on("/status", HTTP_GET, []()
               {
                   String message;
-                  StaticJsonDocument<512> status;
+                  DynamicJsonDocument status(statusDocumentSize);
 
                   // Add version information
                   status["firmwareVersion"] = FIRMWARE_VERSION;
@@ -181,25 +239,145 @@ void initializeWebServer()
                   status["uptime"]          = getUptimeString();
                   status["timestamp"]       = millis();
 
-                  // Add NTRIP connection status
-                  status["enableCaster1"] = settings["enableCaster1"].as<bool>();
-                  status["enableCaster2"] = settings["enableCaster2"].as<bool>();
-                  status["ntripVersion1"] = settings["ntripVersion1"].as<int>();
-                  status["ntripVersion2"] = settings["ntripVersion2"].as<int>();
-
-                  // Use connection opened times for status
-                  status["ntripConnected1"] = NtripPrimaryStatus.connected;
-                  status["ntripConnected2"] = NtripSecondaryStatus.connected;
-
-                  // Calculate uptimes if connected
                   unsigned long currentMillis = millis();
 
-                  if (NtripPrimaryStatus.connectionOpenedAt > 0) {
-                      status["ntripUptime1"] = calculateUptime(currentMillis - NtripPrimaryStatus.connectionOpenedAt);
+                  // Caster outputs, one entry per slot
+                  JsonArray casters = status.createNestedArray("casters");
+                  for (int i = 0; i < NTRIP_CASTER_COUNT; i++) {
+                      const NTRIPStatus &ntripStatus = ntrip_caster_status(i);
+                      const CasterQueueStats queueStats = ntrip_queue_stats(i);
+                      JsonObject caster = casters.createNestedObject();
+                      caster["enabled"]   = settings[casterKey("enableCaster", i + 1)].as<bool>();
+                      caster["version"]   = settings[casterKey("ntripVersion", i + 1)].as<int>();
+                      caster["connected"] = ntripStatus.connected;
+                      if (ntripStatus.connectionOpenedAt > 0) {
+                          caster["uptime"] = calculateUptime(currentMillis - ntripStatus.connectionOpenedAt);
+                      }
+                      caster["bytesSent"]         = ntripStatus.bytesSent;
+                      caster["reconnectAttempts"] = ntripStatus.reconnectAttempts;
+
+                      // This caster's own reconnect schedule
+                      JsonObject backoff = caster.createNestedObject("backoff");
+                      backoff["delayMs"] = ntripStatus.backoff_ms;
+                      if (ntripStatus.nextAttempt_ms != 0) {
+                          const long remaining_ms = (long)(ntripStatus.nextAttempt_ms - currentMillis);
+                          backoff["nextAttemptInMs"] = remaining_ms > 0 ? remaining_ms : 0;
+                      }
+                      caster["handshakeMs"]       = ntripStatus.lastHandshake_ms;
+                      caster["writeStalls"]       = ntripStatus.writeStalls;
+                      caster["slowestWriteMs"]    = ntripStatus.slowestWrite_ms;
+                      caster["lastRecoveryMs"]    = ntripStatus.lastRecovery_ms;
+                      caster["maxRecoveryMs"]     = ntripStatus.maxRecovery_ms;
+                      caster["lastError"]         = getErrorMessage(ntripStatus.lastError);
+
+                      // Hand-off queue between the GNSS UART task and this caster
+                      JsonObject queue = caster.createNestedObject("queue");
+                      queue["drops"]        = queueStats.drops;
+                      queue["staleDrops"]   = queueStats.staleDrops;
+                      queue["limitDrops"]   = queueStats.limitDrops;
+                      queue["burstFrames"]  = queueStats.burstFrames;
+                      queue["highWater"]    = queueStats.highWater;
+                      queue["latencyAvgUs"] = queueStats.latencyAvg_us;
+                      queue["latencyMaxUs"] = queueStats.latencyMax_us;
+
+                      // Write coalescing: segments per epoch and epoch-complete-to-wire latency
+                      JsonObject epochs = caster.createNestedObject("epochs");
+                      epochs["coalesce"]         = settings[casterKey("coalesce", i + 1)].as<bool>();
+                      epochs["count"]            = queueStats.epochs;
+                      epochs["segmentsPerEpoch"] = queueStats.epochs ? (float)queueStats.segments / queueStats.epochs : 0.0f;
+                      epochs["latencyAvgUs"]     = queueStats.epochLatencyAvg_us;
+                      epochs["latencyMaxUs"]     = queueStats.epochLatencyMax_us;
+
+                      // Message filter (setting filter<n>) and what it kept off this caster's link
+                      JsonObject filter = caster.createNestedObject("filter");
+                      filter["rules"]         = settings[casterKey("filter", i + 1)].as<const char *>();
+                      filter["framesDropped"] = queueStats.filterDrops;
+                      filter["bytesSaved"]    = queueStats.filterBytesSaved;
+                      filter["reduceMsm"]     = settings[casterKey("reduceMsm", i + 1)].as<bool>();
+                      filter["msm4Frames"]    = queueStats.reducedFrames;
+                      filter["msm4BytesSaved"] = queueStats.reducedBytesSaved;
+
+                      // GNSS epoch time to written, compare with rtcm.correctionAge for the share of the UART
+                      addAgeStatus(caster.createNestedObject("correctionAge"), queueStats.correctionAge);
+                  }
+
+                  // Flat fields of the first two slots, from before the casters array
+                  for (int i = 0; i < 2 && i < NTRIP_CASTER_COUNT; i++) {
+                      const int n = i + 1;
+                      const NTRIPStatus &ntripStatus = ntrip_caster_status(i);
+                      status[casterKey("enableCaster", n)]    = settings[casterKey("enableCaster", n)].as<bool>();
+                      status[casterKey("ntripVersion", n)]    = settings[casterKey("ntripVersion", n)].as<int>();
+                      status[casterKey("ntripConnected", n)]  = ntripStatus.connected;
+                      if (ntripStatus.connectionOpenedAt > 0) {
+                          status[casterKey("ntripUptime", n)] = calculateUptime(currentMillis - ntripStatus.connectionOpenedAt);
+                      }
                   }
 
-                  if (NtripSecondaryStatus.connectionOpenedAt > 0) {
-                      status["ntripUptime2"] = calculateUptime(currentMillis - NtripSecondaryStatus.connectionOpenedAt);
+                  // LAN caster and its rovers
+                  JsonObject local = status.createNestedObject("localCaster");
+                  addServerStatus(local, localCaster);
+                  local["mount"] = localCaster.mount();
+
+                  // Raw TCP RTCM server and its clients
+                  addServerStatus(status.createNestedObject("tcpServer"), rawServer);
+
+                  // UDP RTCM output, receivers count lost datagrams from the sequence header
+                  const RtcmUdpOutput::Stats udpStats = udpOutput.stats();
+                  JsonObject udp = status.createNestedObject("udpOutput");
+                  udp["enabled"]    = udpOutput.active();
+                  udp["host"]       = udpOutput.host();
+                  udp["port"]       = udpOutput.port();
+                  udp["coalesce"]   = udpOutput.coalescing();
+                  udp["datagrams"]  = udpStats.datagrams;
+                  udp["frames"]     = udpStats.frames;
+                  udp["bytes"]      = udpStats.bytes;
+                  udp["sendErrors"] = udpStats.sendErrors;
+                  udp["drops"]      = udpStats.drops;
+                  udp["sequence"]   = udpStats.sequence;
+
+                  // GNSS UART stream split by protocol
+                  const GnssUartStats uartStats = gnss_uart_stats();
+                  JsonObject uart = status.createNestedObject("gnssUart");
+                  addProtocolStatus(uart.createNestedObject("rtcm"), uartStats.rtcm);
+                  addProtocolStatus(uart.createNestedObject("ubx"), uartStats.ubx);
+                  addProtocolStatus(uart.createNestedObject("nmea"), uartStats.nmea);
+                  uart["rtcmErrors"]   = uartStats.rtcmErrors;
+                  uart["ubxErrors"]    = uartStats.ubxErrors;
+                  uart["nmeaErrors"]   = uartStats.nmeaErrors;
+                  uart["bytesSkipped"] = uartStats.bytesSkipped;
+
+                  // RTCM framing errors and resync results
+                  const rtcmbuffer::Stats &rtcmStats = ntrip_rtcm_stats();
+                  JsonObject rtcm = status.createNestedObject("rtcm");
+                  rtcm["crcErrors"]       = rtcmStats.crc_errors;
+                  rtcm["lengthErrors"]    = rtcmStats.length_errors;
+                  rtcm["bytesSkipped"]    = rtcmStats.bytes_skipped;
+                  rtcm["framesRecovered"] = rtcmStats.frames_recovered;
+                  RtcmFramePool::Slot *arp = injected_frame(InjectedMessage::ARP);
+                  rtcm["synthesisedArp"]  = arp ? rtcmbuffer::get_rtcm_message_type(frameData(arp) + 3) : 0;
+                  rtcm["synthesised1033"] = injected_frame(InjectedMessage::ANTENNA) != nullptr;
+                  // GNSS epoch time to framed: receiver output, UART and checkUblox()
+                  addAgeStatus(rtcm.createNestedObject("correctionAge"), ntrip_uart_age());
+
+                  // MSM headers of the receiver stream: epoch completeness and per-constellation counts
+                  const msm::StreamStats &msmStats = ntrip_msm_stats();
+                  JsonObject msmStatus = rtcm.createNestedObject("msm");
+                  msmStatus["epochs"]                 = msmStats.complete_epochs();
+                  msmStatus["incompleteEpochs"]       = msmStats.incomplete_epochs();
+                  msmStatus["constellationsPerEpoch"] = msmStats.constellations_per_epoch();
+                  JsonObject constellations = msmStatus.createNestedObject("constellations");
+                  for (int i = 0; i < msm::CONSTELLATIONS; i++) {
+                      const msm::ConstellationStats &stats = msmStats.constellation(i);
+                      if (stats.frames == 0) {
+                          continue;
+                      }
+                      JsonObject constellation = constellations.createNestedObject(msm::constellation_name(i));
+                      constellation["msgType"] = stats.msg_type;
+                      constellation["sats"]    = stats.sats;
+                      constellation["signals"] = stats.signals;
+                      constellation["cells"]   = stats.cells;
+                      constellation["frames"]  = stats.frames;
+                      constellation["epochs"]  = stats.epochs;
                   }
 
                   // Rest of the status fields...
@@ -223,6 +401,40 @@ void initializeWebServer()
                   server.send(200, "application/json", message);
               });
 
+    // Per-message-type counters and intervals of the receiver stream
+    server.on("/rtcmTypes", HTTP_GET, []()
+              {
+                  String message;
+                  DynamicJsonDocument stats(8192);  // Up to RtcmTypeStats::MAX_TYPES entries
+
+                  const unsigned long now_ms = millis();
+                  const rtcmbuffer::Stats &framing = ntrip_rtcm_stats();
+                  const RtcmTypeStats &typeStats = ntrip_rtcm_type_stats();
+                  stats["crcErrors"]       = framing.crc_errors;
+                  stats["lengthErrors"]    = framing.length_errors;  // The header was bad, no type to blame
+                  stats["untrackedFrames"] = typeStats.untracked_frames();
+
+                  JsonArray types = stats.createNestedArray("types");
+                  const int count = typeStats.size();
+                  for (int i = 0; i < count; i++) {
+                      const RtcmTypeStats::Entry &entry = typeStats.entry(i);
+                      JsonObject type = types.createNestedObject();
+                      type["type"]           = entry.msg_type;
+                      type["frames"]         = entry.frames;
+                      type["bytes"]          = entry.bytes;
+                      type["crcErrors"]      = entry.crc_errors;
+                      type["lastSeenMsAgo"]  = now_ms - entry.last_ms;
+                      type["intervalMs"]     = entry.interval_ms;
+                      type["jitterMs"]       = entry.jitter_ms;
+                      type["lastIntervalMs"] = entry.last_interval_ms;
+                      type["minIntervalMs"]  = entry.min_interval_ms;
+                      type["maxIntervalMs"]  = entry.max_interval_ms;
+                  }
+
+                  serializeJson(stats, message);
+                  server.send(200, "application/json", message);
+              });
+
     // SECURITY: Removed GET handler for applySettings to prevent credentials in query parameters
     // Only POST is allowed to protect sensitive data (passwords) from being logged
 
@@ -3,53 +3,103 @@
 #include <ArduinoJson.h>
 #include "settings.h"
 #include "log.h"
+#include <core/defines.h>
+#include "network/rtcm_filter.h"
 
-DynamicJsonDocument settings(1024);
+// Per caster slot: 12 members, their String keys (~150 B) and up to ~250 B of host, mountpoint,
+// credentials and filter. The rest: 30 members with the 1033 descriptor strings and some slack.
+constexpr size_t settingsPerCaster = JSON_OBJECT_SIZE(12) + 416;
+constexpr size_t settingsFixed = JSON_OBJECT_SIZE(30) + 1568;
+
+DynamicJsonDocument settings(settingsFixed + NTRIP_CASTER_COUNT * settingsPerCaster);
 DynamicJsonDocument status(1024);
 
 Preferences preferences;
 
+String casterKey(const char *prefix, const int number)
+{
+  return String(prefix) + number;
+}
+
+// True for "<prefix><n>" with n a caster slot number (1..NTRIP_CASTER_COUNT)
+static bool isCasterKey(const String &name, const char *prefix)
+{
+  if (!name.startsWith(prefix)) {
+    return false;
+  }
+  // The number has to end the key: no trailing characters, no leading zeros
+  for (int n = 1; n <= NTRIP_CASTER_COUNT; n++) {
+    if (name == casterKey(prefix, n)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool readSettings()
 {
   preferences.begin("settings", false);
   settings["ntrip_sName"] = preferences.getString("ntrip_sName", "");
-  settings["enableCaster1"] = preferences.getBool("enableCaster1", false);
-  settings["enableCaster2"] = preferences.getBool("enableCaster2", false);
-  settings["casterHost1"] = preferences.getString("casterHost1", "");
-  settings["casterHost2"] = preferences.getString("casterHost2", "");
-  settings["casterPort1"] = preferences.getUShort("casterPort1", 0);
-  settings["casterPort2"] = preferences.getUShort("casterPort2", 0);
-  settings["rtk_mntpnt1"] = preferences.getString("rtk_mntpnt1", "");
-  settings["rtk_mntpnt2"] = preferences.getString("rtk_mntpnt2", "");
-  settings["rtk_mntpnt_pw1"] = preferences.getString("rtk_mntpnt_pw1", "");
-  settings["rtk_mntpnt_pw2"] = preferences.getString("rtk_mntpnt_pw2", "");
-
-  // Try new key names first, then fall back to old key names
-  String user1 = preferences.getString("user1", "");
-  if (user1.isEmpty()) {
-    user1 = preferences.getString("rtk_mntpnt_user1", "");
-    if (!user1.isEmpty()) {
-      // Migrate old key to new key
-      preferences.putString("user1", user1);
-      preferences.remove("rtk_mntpnt_user1");
-    }
-  }
-  settings["rtk_mntpnt_user1"] = user1;
-
-  String user2 = preferences.getString("user2", "");
-  if (user2.isEmpty()) {
-    user2 = preferences.getString("rtk_mntpnt_user2", "");
-    if (!user2.isEmpty()) {
-      // Migrate old key to new key
-      preferences.putString("user2", user2);
-      preferences.remove("rtk_mntpnt_user2");
-    }
-  }
-  settings["rtk_mntpnt_user2"] = user2;
+
+  for (int n = 1; n <= NTRIP_CASTER_COUNT; n++) {
+    settings[casterKey("enableCaster", n)] = preferences.getBool(casterKey("enableCaster", n).c_str(), false);
+    settings[casterKey("casterHost", n)] = preferences.getString(casterKey("casterHost", n).c_str(), "");
+    settings[casterKey("casterPort", n)] = preferences.getUShort(casterKey("casterPort", n).c_str(), 0);
+    settings[casterKey("rtk_mntpnt", n)] = preferences.getString(casterKey("rtk_mntpnt", n).c_str(), "");
+    settings[casterKey("rtk_mntpnt_pw", n)] = preferences.getString(casterKey("rtk_mntpnt_pw", n).c_str(), "");
+
+    // Try new key names first, then fall back to old key names
+    const String userKey = casterKey("user", n);
+    const String oldUserKey = casterKey("rtk_mntpnt_user", n);
+    String user = preferences.getString(userKey.c_str(), "");
+    if (user.isEmpty()) {
+      user = preferences.getString(oldUserKey.c_str(), "");
+      if (!user.isEmpty()) {
+        // Migrate old key to new key
+        preferences.putString(userKey.c_str(), user);
+        preferences.remove(oldUserKey.c_str());
+      }
+    }
+    settings[oldUserKey] = user;
+
+    settings[casterKey("ntripVersion", n)] = preferences.getInt(casterKey("ntripVersion", n).c_str(), 1);  // Default to 1 if not set
+    settings[casterKey("coalesce", n)] = preferences.getBool(casterKey("coalesce", n).c_str(), true);  // Epoch-aligned writes
+    settings[casterKey("arpRate", n)] = preferences.getUShort(casterKey("arpRate", n).c_str(), 10);  // Seconds, 0 = off
+    settings[casterKey("infoRate", n)] = preferences.getUShort(casterKey("infoRate", n).c_str(), 10);  // 1033, seconds
+    settings[casterKey("filter", n)] = preferences.getString(casterKey("filter", n).c_str(), "");  // See rtcm_filter.h
+    settings[casterKey("reduceMsm", n)] = preferences.getBool(casterKey("reduceMsm", n).c_str(), false);  // MSM7 as MSM4
+  }
+
+  settings["localCaster"] = preferences.getBool("localCaster", false);
+  settings["localCasterPort"] = preferences.getUShort("localCasterPort", 2101);
+  settings["localMount"] = preferences.getString("localMount", "BASE");
+  settings["tcpServer"] = preferences.getBool("tcpServer", false);
+  settings["tcpServerPort"] = preferences.getUShort("tcpServerPort", 2102);
+  settings["udpOutput"] = preferences.getBool("udpOutput", false);
+  settings["udpHost"] = preferences.getString("udpHost", "");  // Unicast or multicast IPv4 address
+  settings["udpPort"] = preferences.getUShort("udpPort", 2103);
+  settings["udpCoalesce"] = preferences.getBool("udpCoalesce", true);  // One datagram per epoch
+  settings["localArpRate"] = preferences.getUShort("localArpRate", 10);
+  settings["tcpArpRate"] = preferences.getUShort("tcpArpRate", 10);
+  settings["udpArpRate"] = preferences.getUShort("udpArpRate", 10);
+  settings["localInfoRate"] = preferences.getUShort("localInfoRate", 10);
+  settings["tcpInfoRate"] = preferences.getUShort("tcpInfoRate", 10);
+  settings["udpInfoRate"] = preferences.getUShort("udpInfoRate", 10);
+
+  // Station messages synthesised from ecefX/Y/Z instead of the receiver's 1005
+  settings["arpSynth"] = preferences.getBool("arpSynth", false);
+  settings["stationId"] = preferences.getUShort("stationId", 0);
+  settings["antHeight"] = preferences.getUShort("antHeight", 0);  // 0.1 mm, 0 = send 1005 instead of 1006
+  // RTCM 1033 descriptors, sent once any of antDescriptor/rcvType/rcvFirmware is set
+  settings["antDescriptor"] = preferences.getString("antDescriptor", "");  // IGS antenna + radome name
+  settings["antSetupId"] = preferences.getUChar("antSetupId", 0);
+  settings["antSerial"] = preferences.getString("antSerial", "");
+  settings["rcvType"] = preferences.getString("rcvType", "");
+  settings["rcvFirmware"] = preferences.getString("rcvFirmware", "");
+  settings["rcvSerial"] = preferences.getString("rcvSerial", "");
 
   settings["rtcmChk"] = preferences.getBool("rtcmChk", true);
-  settings["ntripVersion1"] = preferences.getInt("ntripVersion1", 1);  // Default to 1 if not set
-  settings["ntripVersion2"] = preferences.getInt("ntripVersion2", 1);  // Default to 1 if not set
+  settings["stallTimeout"] = preferences.getUShort("stallTimeout", NTRIP_WRITE_STALL_MS);  // Caster write stall threshold, ms
   settings["ecefX"] = preferences.getLong64("ecefX", 0);
   settings["ecefY"] = preferences.getLong64("ecefY", 0);
   settings["ecefZ"] = preferences.getLong64("ecefZ", 0);
@@ -76,14 +126,15 @@ bool writeSettings(String name, String value)
   debugf("Writing setting %s: %s", name.c_str(), value.c_str());
 
   // Add length validation for username fields
-  if (name == "rtk_mntpnt_user1" || name == "rtk_mntpnt_user2") {
+  if (isCasterKey(name, "rtk_mntpnt_user")) {
     if (value.length() > 15) { // Limit username to 15 characters
       errorf("Username too long (max 15 chars): %s", value.c_str());
       value = value.substring(0, 15);
     }
   }
 
-  if (name == "casterPort1" || name == "casterPort2")
+  if (isCasterKey(name, "casterPort") || name == "localCasterPort" || name == "tcpServerPort" ||
+      name == "udpPort")
   {
     int portInt = value.toInt();
     // Validate port range (1-65535)
@@ -95,14 +146,76 @@ bool writeSettings(String name, String value)
     debugf("Converting port value to uint16_t: %d", portValue);
     preferences.putUShort(name.c_str(), portValue);
   }
-  else if (name == "enableCaster1" || name == "enableCaster2" || name == "rtcmChk")
+  else if (isCasterKey(name, "enableCaster") || isCasterKey(name, "coalesce") || isCasterKey(name, "reduceMsm") ||
+           name == "rtcmChk" || name == "localCaster" || name == "tcpServer" || name == "udpOutput" ||
+           name == "udpCoalesce" || name == "arpSynth")
   {
     bool boolValue = (value == "on" || value == "true" || value == "1");
     debugf("Converting to bool: %d", boolValue);
     const char* key = (name == "rtcmChk") ? "rtcmChk" : name.c_str();
     preferences.putBool(key, boolValue);
   }
-  else if (name == "ntripVersion1" || name == "ntripVersion2")
+  else if (isCasterKey(name, "arpRate") || name == "localArpRate" || name == "tcpArpRate" || name == "udpArpRate" ||
+           isCasterKey(name, "infoRate") || name == "localInfoRate" || name == "tcpInfoRate" || name == "udpInfoRate")
+  {
+    int rate = value.toInt();
+    if (rate < 0 || rate > 3600) {
+      errorf("Invalid interval %d s for %s (must be 0-3600), using default 10", rate, name.c_str());
+      rate = 10;
+    }
+    preferences.putUShort(name.c_str(), (uint16_t)rate);
+  }
+  else if (name == "stationId" || name == "antHeight")
+  {
+    int fieldValue = value.toInt();
+    // DF003 is 12 bits, DF028 16 bits (0.1 mm, up to 6.5535 m)
+    const int maxValue = (name == "stationId") ? 4095 : 65535;
+    if (fieldValue < 0 || fieldValue > maxValue) {
+      errorf("Invalid value %d for %s (must be 0-%d), using 0", fieldValue, name.c_str(), maxValue);
+      fieldValue = 0;
+    }
+    preferences.putUShort(name.c_str(), (uint16_t)fieldValue);
+  }
+  else if (name == "antSetupId")
+  {
+    int setupId = value.toInt();
+    // DF031 is 8 bits
+    if (setupId < 0 || setupId > 255) {
+      errorf("Invalid antenna setup ID %d (must be 0-255), using 0", setupId);
+      setupId = 0;
+    }
+    preferences.putUChar("antSetupId", (uint8_t)setupId);
+  }
+  else if (name == "antDescriptor" || name == "antSerial" || name == "rcvType" || name == "rcvFirmware" ||
+           name == "rcvSerial")
+  {
+    // 1033 strings carry at most 31 characters
+    if (value.length() > 31) {
+      errorf("%s too long (max 31 chars): %s", name.c_str(), value.c_str());
+      value = value.substring(0, 31);
+    }
+    preferences.putString(name.c_str(), value);
+  }
+  else if (name == "stallTimeout")
+  {
+    int stallMs = value.toInt();
+    // Below ~0.5 s a busy uplink trips it, above a minute it no longer helps
+    if (stallMs < 500 || stallMs > 60000) {
+      errorf("Invalid stall timeout %d ms (must be 500-60000), using default %d", stallMs, NTRIP_WRITE_STALL_MS);
+      stallMs = NTRIP_WRITE_STALL_MS;
+    }
+    preferences.putUShort(name.c_str(), (uint16_t)stallMs);
+  }
+  else if (isCasterKey(name, "filter"))
+  {
+    RtcmFilter filter;
+    if (!filter.parse(value.c_str())) {
+      errorf("Invalid message filter for %s: %s, forwarding everything", name.c_str(), value.c_str());
+      value = "";
+    }
+    preferences.putString(name.c_str(), value);
+  }
+  else if (isCasterKey(name, "ntripVersion"))
   {
     int version = value.toInt();
     // Validate NTRIP version (only 1 or 2 are valid)
@@ -150,15 +263,10 @@ bool writeSettings(String name, String value)
   else
   {
     // Use shorter key names for username fields
-    if (name == "rtk_mntpnt_user1") {
-      preferences.putString("user1", value);
-      // Remove old key if it exists
-      preferences.remove("rtk_mntpnt_user1");
-    }
-    else if (name == "rtk_mntpnt_user2") {
-      preferences.putString("user2", value);
+    if (isCasterKey(name, "rtk_mntpnt_user")) {
+      preferences.putString(("user" + name.substring(strlen("rtk_mntpnt_user"))).c_str(), value);
       // Remove old key if it exists
-      preferences.remove("rtk_mntpnt_user2");
+      preferences.remove(name.c_str());
     }
     else {
       preferences.putString(name.c_str(), value);
@@ -9,4 +9,7 @@ extern DynamicJsonDocument status;
 bool readSettings();
 bool writeSettings(String name, String value);
 bool writeSettings(String name, double value);
-bool writeSettings(String name, int64_t value);
\ No newline at end of file
+bool writeSettings(String name, int64_t value);
+
+// Settings key of a caster slot, e.g. casterKey("casterHost", 3) -> "casterHost3"
+String casterKey(const char *prefix, int number);
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include <unity.h>
+#include <stdint.h>
+
+#include "network/backoff.h"
+
+using namespace backoff;
+
+static const uint32_t BASE_MS = 5000;
+static const uint32_t CAP_MS = 60000;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_ceiling_doubles_per_attempt(void) {
+    TEST_ASSERT_EQUAL_UINT32(5000, ceiling(BASE_MS, CAP_MS, 0));
+    TEST_ASSERT_EQUAL_UINT32(5000, ceiling(BASE_MS, CAP_MS, 1));
+    TEST_ASSERT_EQUAL_UINT32(10000, ceiling(BASE_MS, CAP_MS, 2));
+    TEST_ASSERT_EQUAL_UINT32(20000, ceiling(BASE_MS, CAP_MS, 3));
+    TEST_ASSERT_EQUAL_UINT32(40000, ceiling(BASE_MS, CAP_MS, 4));
+}
+
+// Capped, and no overflow however many attempts failed
+void test_ceiling_capped(void) {
+    TEST_ASSERT_EQUAL_UINT32(CAP_MS, ceiling(BASE_MS, CAP_MS, 5));
+    TEST_ASSERT_EQUAL_UINT32(CAP_MS, ceiling(BASE_MS, CAP_MS, 1000));
+}
+
+// Jitter stays within [ceiling / 2, ceiling]
+void test_jitter_bounds(void) {
+    const uint32_t randoms[] = {0, 1, 2500, 9999, 10000, 0x7FFFFFFF, 0xFFFFFFFF};
+    for (int attempts = 0; attempts < 10; attempts++) {
+        const uint32_t ceiling_ms = ceiling(BASE_MS, CAP_MS, attempts);
+        for (uint32_t random : randoms) {
+            const uint32_t delay_ms = delay(BASE_MS, CAP_MS, attempts, random);
+            TEST_ASSERT_TRUE(delay_ms >= ceiling_ms / 2);
+            TEST_ASSERT_TRUE(delay_ms <= ceiling_ms);
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(2500, delay(BASE_MS, CAP_MS, 1, 0));
+    TEST_ASSERT_EQUAL_UINT32(5000, delay(BASE_MS, CAP_MS, 1, 2500));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ceiling_doubles_per_attempt);
+    RUN_TEST(test_ceiling_capped);
+    RUN_TEST(test_jitter_bounds);
+
+    return UNITY_END();
+}
@@ -0,0 +1,68 @@
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "network/chunk_frame.h"
+
+using namespace chunk_frame;
+
+static uint8_t buffer[CHUNK_HEADROOM + 1029 + CHUNK_TAILROOM];
+static uint8_t* const frame = buffer + CHUNK_HEADROOM;
+
+void setUp(void) {
+    memset(buffer, 0xEE, sizeof(buffer));
+}
+
+void tearDown(void) {}
+
+// The chunk view must match what snprintf("%X\r\n") + payload + "\r\n" produced
+static void check_chunk(size_t len) {
+    memset(frame, 0xD3, len);
+    encode_chunk(frame, len);
+
+    char expected_header[10];
+    const int header = snprintf(expected_header, sizeof(expected_header), "%X\r\n", (unsigned)len);
+    TEST_ASSERT_EQUAL_INT(header, (int)header_len(len));
+    TEST_ASSERT_EQUAL_INT(header + (int)len + 2, (int)chunk_len(len));
+
+    const uint8_t* chunk = chunk_start(frame, len);
+    TEST_ASSERT_EQUAL_MEMORY(expected_header, chunk, header);
+    TEST_ASSERT_EQUAL_UINT8(0xD3, chunk[header]);
+    TEST_ASSERT_EQUAL_UINT8('\r', frame[len]);
+    TEST_ASSERT_EQUAL_UINT8('\n', frame[len + 1]);
+}
+
+void test_chunk_header_digit_boundaries(void) {
+    const size_t lengths[] = {6, 15, 16, 255, 256, 1029};
+    for (size_t len : lengths) {
+        setUp();
+        check_chunk(len);
+    }
+}
+
+// Encoding leaves the raw frame untouched for NTRIP 1.0 outputs
+void test_raw_view_unchanged(void) {
+    for (size_t i = 0; i < 300; i++) frame[i] = (uint8_t)i;
+    encode_chunk(frame, 300);
+    for (size_t i = 0; i < 300; i++) {
+        TEST_ASSERT_EQUAL_UINT8((uint8_t)i, frame[i]);
+    }
+}
+
+// Header stays inside the headroom for every valid frame length
+void test_header_fits_headroom(void) {
+    for (size_t len = 6; len <= 1029; len++) {
+        TEST_ASSERT_TRUE(header_len(len) <= CHUNK_HEADROOM);
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_chunk_header_digit_boundaries);
+    RUN_TEST(test_raw_view_unchanged);
+    RUN_TEST(test_header_fits_headroom);
+
+    return UNITY_END();
+}
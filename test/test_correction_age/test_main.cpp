@@ -0,0 +1,152 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "network/correction_age.h"
+#include "network/msm.h"
+#include "network/rtcm_encoder.h"
+
+static const int MAX_LEN = 64;
+
+// MSM header with one satellite, one signal and one cell; decode_header reads no further
+static int make_msm(uint8_t *frame, const int msg_type, const uint32_t epoch_time) {
+    memset(frame, 0, MAX_LEN);
+    rtcm_encoder::BitWriter bits(frame + 3);
+    bits.put(msg_type, 12);
+    bits.put(2003, 12);
+    bits.put(epoch_time, 30);
+    bits.put(0, 1 + 3 + 7 + 2 + 2 + 1 + 3);
+    bits.put(1ULL << 63, 64);
+    bits.put(1u << 31, 32);
+    bits.put(1, 1);
+    return rtcm_encoder::finish_frame(frame, (bits.bits_written() + 7) / 8);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_clock_runs_from_reference(void) {
+    GnssClock clock;
+    uint32_t tow_ms;
+    TEST_ASSERT_FALSE(clock.time_of_week(1000, tow_ms));
+
+    clock.set(345600000, 50000);
+    TEST_ASSERT_TRUE(clock.time_of_week(50000, tow_ms));
+    TEST_ASSERT_EQUAL_UINT32(345600000, tow_ms);
+    TEST_ASSERT_TRUE(clock.time_of_week(51234, tow_ms));
+    TEST_ASSERT_EQUAL_UINT32(345601234, tow_ms);
+    // Without a new PVT the reference goes stale
+    TEST_ASSERT_FALSE(clock.time_of_week(50000 + GnssClock::STALE_MS + 1, tow_ms));
+}
+
+// Week rollover of the GNSS time and wrap of the local ms counter
+void test_clock_wraps(void) {
+    GnssClock clock;
+    uint32_t tow_ms;
+    clock.set(msm::WEEK_MS - 500, 0xFFFFFF00u);
+    TEST_ASSERT_TRUE(clock.time_of_week(0xFFFFFF00u + 700, tow_ms));
+    TEST_ASSERT_EQUAL_UINT32(200, tow_ms);
+}
+
+void test_age_per_constellation(void) {
+    GnssClock clock;
+    uint8_t frame[MAX_LEN];
+    uint32_t age_ms;
+    clock.set(100000000, 1000);
+
+    int len = make_msm(frame, 1077, 100000000 - 80);
+    TEST_ASSERT_TRUE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    TEST_ASSERT_EQUAL_UINT32(80, age_ms);
+    TEST_ASSERT_TRUE(correction_age_ms(clock, frame, len, 1045, age_ms));
+    TEST_ASSERT_EQUAL_UINT32(125, age_ms);
+
+    // BeiDou time is 14 s behind GPS time
+    len = make_msm(frame, 1127, 100000000 - 14000 - 80);
+    TEST_ASSERT_TRUE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    TEST_ASSERT_EQUAL_UINT32(80, age_ms);
+
+    len = make_msm(frame, 1097, 100000000 - 80);
+    TEST_ASSERT_TRUE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    TEST_ASSERT_EQUAL_UINT32(80, age_ms);
+
+    // An epoch just ahead of the clock counts as fresh
+    len = make_msm(frame, 1074, 100000000 + 20);
+    TEST_ASSERT_TRUE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    TEST_ASSERT_EQUAL_UINT32(0, age_ms);
+
+    // Across the week rollover
+    clock.set(300, 1000);
+    len = make_msm(frame, 1077, msm::WEEK_MS - 200);
+    TEST_ASSERT_TRUE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    TEST_ASSERT_EQUAL_UINT32(500, age_ms);
+}
+
+void test_age_needs_msm_and_clock(void) {
+    GnssClock clock;
+    uint8_t frame[MAX_LEN];
+    uint32_t age_ms;
+    int len = make_msm(frame, 1077, 1000);
+    TEST_ASSERT_FALSE(correction_age_ms(clock, frame, len, 1000, age_ms));
+
+    clock.set(2000, 1000);
+    len = make_msm(frame, 1087, 1000);  // GLONASS day of week + time of day
+    TEST_ASSERT_FALSE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    len = make_msm(frame, 1005, 1000);
+    TEST_ASSERT_FALSE(correction_age_ms(clock, frame, len, 1000, age_ms));
+    len = make_msm(frame, 1077, 1000);
+    TEST_ASSERT_FALSE(correction_age_ms(clock, frame, 10, 1000, age_ms));
+}
+
+// Buckets are contiguous and each bound is within 12.5% of the values in it
+void test_histogram_buckets(void) {
+    int previous = -1;
+    for (uint32_t age_ms = 0; age_ms <= AgeHistogram::MAX_AGE_MS; age_ms++) {
+        const int index = AgeHistogram::bucket(age_ms);
+        TEST_ASSERT_TRUE(index == previous || index == previous + 1);
+        TEST_ASSERT_TRUE(AgeHistogram::bucket_upper(index) >= age_ms);
+        TEST_ASSERT_TRUE(AgeHistogram::bucket_upper(index) <= age_ms + age_ms / 8);
+        previous = index;
+    }
+    TEST_ASSERT_EQUAL_INT(AgeHistogram::BUCKETS - 1, previous);
+    TEST_ASSERT_EQUAL_INT(AgeHistogram::BUCKETS - 1, AgeHistogram::bucket(1000000));
+}
+
+void test_histogram_percentiles(void) {
+    AgeHistogram histogram;
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.percentile(50));
+
+    // 90 fast epochs, 9 slower, one stalled write
+    for (int i = 0; i < 90; i++) {
+        histogram.record(40);
+    }
+    for (int i = 0; i < 9; i++) {
+        histogram.record(300);
+    }
+    histogram.record(2500);
+
+    const AgeSummary summary = histogram.summary();
+    TEST_ASSERT_EQUAL_UINT32(100, summary.samples);
+    TEST_ASSERT_EQUAL_UINT32(AgeHistogram::bucket_upper(AgeHistogram::bucket(40)), summary.p50_ms);
+    TEST_ASSERT_EQUAL_UINT32(AgeHistogram::bucket_upper(AgeHistogram::bucket(300)), summary.p95_ms);
+    TEST_ASSERT_EQUAL_UINT32(AgeHistogram::bucket_upper(AgeHistogram::bucket(300)), summary.p99_ms);
+    TEST_ASSERT_EQUAL_UINT32(2500, summary.max_ms);
+    TEST_ASSERT_EQUAL_UINT32(2500, histogram.percentile(100));
+
+    histogram.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.samples());
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.max_ms());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_clock_runs_from_reference);
+    RUN_TEST(test_clock_wraps);
+    RUN_TEST(test_age_per_constellation);
+    RUN_TEST(test_age_needs_msm_and_clock);
+    RUN_TEST(test_histogram_buckets);
+    RUN_TEST(test_histogram_percentiles);
+
+    return UNITY_END();
+}
@@ -0,0 +1,142 @@
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "network/crc24q.h"
+
+// ----- Bitwise CRC24Q reference (no tables) -----
+static uint32_t crc24q_bitwise(const uint8_t* data, size_t len) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= ((uint32_t)data[i]) << 16;
+        for (int b = 0; b < 8; b++) {
+            crc <<= 1;
+            if (crc & 0x1000000) crc ^= 0x1864CFB;
+        }
+    }
+    return crc & 0xFFFFFF;
+}
+
+// Deterministic pseudo-random payload (xorshift32)
+static std::vector<uint8_t> make_data(size_t len, uint32_t seed) {
+    std::vector<uint8_t> data(len);
+    for (size_t i = 0; i < len; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        data[i] = seed & 0xFF;
+    }
+    return data;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Table 0 must match the runtime table rtcmbuffer::init() used to build.
+void test_table_matches_bitwise(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint8_t byte = (uint8_t)i;
+        TEST_ASSERT_EQUAL_HEX32(crc24q_bitwise(&byte, 1), crc24q::Tables<>::t[0].v[i]);
+    }
+}
+
+// Standard check value for CRC-24Q ("123456789").
+void test_check_value(void) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX32(0xCDE703, crc24q::update(0, check, sizeof(check)));
+    TEST_ASSERT_EQUAL_HEX32(0xCDE703, crc24q::update_sliced4(0, check, sizeof(check)));
+    TEST_ASSERT_EQUAL_HEX32(0xCDE703, crc24q::update_sliced8(0, check, sizeof(check)));
+}
+
+// All kernels agree for every length around the slice widths, up to MSM7 max.
+void test_kernels_agree_all_lengths(void) {
+    auto data = make_data(1029, 0x12345678);
+    for (size_t len = 0; len <= data.size(); len++) {
+        const uint32_t expected = crc24q_bitwise(data.data(), len);
+        char msg[48];
+        snprintf(msg, sizeof(msg), "len=%u", (unsigned)len);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected, crc24q::update(0, data.data(), len), msg);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected, crc24q::update_sliced4(0, data.data(), len), msg);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected, crc24q::update_sliced8(0, data.data(), len), msg);
+    }
+}
+
+// Block kernels continue correctly from a running register (split input).
+void test_sliced_continues_running_crc(void) {
+    auto data = make_data(700, 0xCAFEBABE);
+    const uint32_t expected = crc24q_bitwise(data.data(), data.size());
+    for (size_t split = 0; split <= data.size(); split += 37) {
+        uint32_t crc = 0;
+        for (size_t i = 0; i < split; i++) crc = crc24q::update(crc, data[i]);
+        TEST_ASSERT_EQUAL_HEX32(expected, crc24q::update_sliced8(crc, data.data() + split, data.size() - split));
+    }
+}
+
+// compute() over a max-size frame matches the reference, and over the frame
+// including its stored CRC yields zero.
+void test_compute_on_rtcm_frame(void) {
+    auto frame = make_data(1029, 42);
+    frame[0] = 0xD3;
+    frame[1] = 0x03;
+    frame[2] = 0xFF;  // 1023 byte payload
+    const uint32_t crc = crc24q_bitwise(frame.data(), 1026);
+    frame[1026] = (crc >> 16) & 0xFF;
+    frame[1027] = (crc >> 8) & 0xFF;
+    frame[1028] = crc & 0xFF;
+    TEST_ASSERT_EQUAL_HEX32(crc, crc24q::compute(frame.data(), 1026));
+    // CRC over the whole frame including its own CRC is zero for this polynomial form
+    TEST_ASSERT_EQUAL_HEX32(0, crc24q::compute(frame.data(), 1029));
+}
+
+// ----- Benchmark -----
+// Throughput on 1029-byte MSM7-sized frames. "bytewise" is the previous
+// rtcmbuffer implementation (one table lookup per byte).
+
+typedef uint32_t (*crc_fn)(uint32_t, const uint8_t*, size_t);
+
+static uint32_t bytewise(uint32_t crc, const uint8_t* d, size_t n) { return crc24q::update(crc, d, n); }
+
+// Keeps the benchmark loops from being optimised away
+static volatile uint32_t bench_sink = 0;
+
+static double bench(crc_fn fn, const std::vector<uint8_t>& frame) {
+    const int iterations = 20000;
+    uint32_t acc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        acc ^= fn(acc & 0xFF, frame.data(), frame.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+    bench_sink ^= acc;
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    return (double)frame.size() * iterations / seconds;
+}
+
+void test_benchmark_throughput(void) {
+    auto frame = make_data(1029, 7);
+    const double base = bench(bytewise, frame);
+    const double s4 = bench(crc24q::update_sliced4, frame);
+    const double s8 = bench(crc24q::update_sliced8, frame);
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "CRC24Q 1029B frames: bytewise %.1f MB/s, slicing-by-4 %.1f MB/s (x%.2f), slicing-by-8 %.1f MB/s (x%.2f)",
+             base / 1e6, s4 / 1e6, s4 / base, s8 / 1e6, s8 / base);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(base > 0 && s4 > 0 && s8 > 0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_table_matches_bitwise);
+    RUN_TEST(test_check_value);
+    RUN_TEST(test_kernels_agree_all_lengths);
+    RUN_TEST(test_sliced_continues_running_crc);
+    RUN_TEST(test_compute_on_rtcm_frame);
+    RUN_TEST(test_benchmark_throughput);
+
+    return UNITY_END();
+}
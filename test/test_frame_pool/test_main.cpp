@@ -0,0 +1,97 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "network/frame_pool.h"
+
+typedef FramePool<8, 32> Pool;
+
+static Pool* pool = nullptr;
+
+void setUp(void) {
+    pool = new Pool();
+    pool->begin(4);
+}
+
+void tearDown(void) {
+    delete pool;
+    pool = nullptr;
+}
+
+void test_acquire_distinct_slots(void) {
+    Pool::Slot* a = pool->acquire();
+    Pool::Slot* b = pool->acquire();
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_TRUE(a != b);
+    TEST_ASSERT_EQUAL_INT(1, a->refs.load());
+    TEST_ASSERT_EQUAL_INT(2, (int)pool->in_use());
+}
+
+void test_exhaustion_and_reuse(void) {
+    Pool::Slot* slots[4];
+    for (int i = 0; i < 4; i++) {
+        slots[i] = pool->acquire();
+        TEST_ASSERT_NOT_NULL(slots[i]);
+    }
+    TEST_ASSERT_NULL(pool->acquire());
+    TEST_ASSERT_NULL(pool->acquire());
+    TEST_ASSERT_EQUAL_UINT32(2, pool->exhausted_count());
+
+    Pool::release(slots[2]);
+    TEST_ASSERT_EQUAL_PTR(slots[2], pool->acquire());
+}
+
+// A slot stays in use until the writer and every consumer have released it
+void test_refcount_shared_by_consumers(void) {
+    Pool::Slot* frame = pool->acquire();
+    TEST_ASSERT_NOT_NULL(frame);
+    memset(frame->data, 0xAB, sizeof(frame->data));
+    frame->len = 32;
+
+    Pool::retain(frame);  // Consumer 1
+    Pool::retain(frame);  // Consumer 2
+    Pool::release(frame); // Writer done
+    TEST_ASSERT_EQUAL_INT(1, (int)pool->in_use());
+
+    Pool::release(frame);
+    TEST_ASSERT_EQUAL_INT(1, (int)pool->in_use());
+    Pool::release(frame);
+    TEST_ASSERT_EQUAL_INT(0, (int)pool->in_use());
+}
+
+// Only the slots begin() allocated are handed out, never more than MaxSlots
+void test_capacity_set_at_begin(void) {
+    Pool small;
+    TEST_ASSERT_NULL(small.acquire());
+    TEST_ASSERT_EQUAL_INT(2, (int)small.begin(2));
+    TEST_ASSERT_EQUAL_INT(2, (int)small.capacity());
+    TEST_ASSERT_NOT_NULL(small.acquire());
+    TEST_ASSERT_NOT_NULL(small.acquire());
+    TEST_ASSERT_NULL(small.acquire());
+
+    Pool large;
+    TEST_ASSERT_EQUAL_INT(8, (int)large.begin(100));
+    TEST_ASSERT_EQUAL_INT(8, (int)Pool::max_capacity());
+}
+
+// acquire() rotates through the slots so a just-freed slot isn't handed out
+// again while older free slots exist
+void test_round_robin(void) {
+    Pool::Slot* a = pool->acquire();
+    Pool::release(a);
+    Pool::Slot* b = pool->acquire();
+    TEST_ASSERT_TRUE(a != b);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_acquire_distinct_slots);
+    RUN_TEST(test_exhaustion_and_reuse);
+    RUN_TEST(test_refcount_shared_by_consumers);
+    RUN_TEST(test_capacity_set_at_begin);
+    RUN_TEST(test_round_robin);
+
+    return UNITY_END();
+}
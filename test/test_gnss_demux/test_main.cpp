@@ -0,0 +1,324 @@
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "hardware/gnss_demux.h"
+#include "network/rtcmbuffer.h"
+#include "network/rtcm_encoder.h"
+
+// What the demultiplexer handed over
+struct Recorded {
+    std::vector<uint8_t> rtcm;  // Concatenated RTCM runs
+    std::vector<std::vector<uint8_t>> ubx;
+    std::vector<std::string> nmea;
+};
+
+struct RecordingHandler {
+    Recorded *out;
+    explicit RecordingHandler(Recorded *out = nullptr) : out(out) {}
+    void rtcm(const uint8_t *data, size_t len) const { out->rtcm.insert(out->rtcm.end(), data, data + len); }
+    void ubx(const uint8_t *frame, size_t len) const { out->ubx.push_back(std::vector<uint8_t>(frame, frame + len)); }
+    void nmea(const uint8_t *sentence, size_t len) const { out->nmea.push_back(std::string((const char *)sentence, len)); }
+};
+
+typedef GnssDemux<256, 96, RecordingHandler> Demux;
+
+static std::vector<uint8_t> ubx_frame(const uint8_t cls, const uint8_t id, const size_t payload_len) {
+    std::vector<uint8_t> frame = {0xB5, 0x62, cls, id, (uint8_t)payload_len, (uint8_t)(payload_len >> 8)};
+    for (size_t i = 0; i < payload_len; i++) {
+        // Sync bytes of every protocol inside the payload
+        const uint8_t values[] = {0xD3, 0xB5, 0x62, '$', (uint8_t)i};
+        frame.push_back(values[i % 5]);
+    }
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+    for (size_t i = 2; i < frame.size(); i++) {
+        ck_a += frame[i];
+        ck_b += ck_a;
+    }
+    frame.push_back(ck_a);
+    frame.push_back(ck_b);
+    return frame;
+}
+
+static std::vector<uint8_t> rtcm_frame(const int msg_type, const size_t payload_len) {
+    std::vector<uint8_t> frame(payload_len + 6, 0);
+    rtcm_encoder::BitWriter bits(&frame[3]);
+    bits.put(msg_type, 12);
+    for (size_t i = 12; i + 8 <= payload_len * 8; i += 8) {
+        const uint8_t values[] = {0xB5, 0x62, '$', 0xD3, '\n'};
+        bits.put(values[(i / 8) % 5], 8);
+    }
+    rtcm_encoder::finish_frame(&frame[0], payload_len);
+    return frame;
+}
+
+static std::string nmea_sentence(const char *body) {
+    uint8_t checksum = 0;
+    for (const char *c = body; *c; c++) {
+        checksum ^= (uint8_t)*c;
+    }
+    char tail[8];
+    snprintf(tail, sizeof(tail), "*%02X\r\n", checksum);
+    return std::string("$") + body + tail;
+}
+
+static void append(std::vector<uint8_t> &stream, const std::vector<uint8_t> &bytes) {
+    stream.insert(stream.end(), bytes.begin(), bytes.end());
+}
+
+static void append(std::vector<uint8_t> &stream, const std::string &text) {
+    stream.insert(stream.end(), text.begin(), text.end());
+}
+
+// One second of a base station's UART: NMEA, MSMs, PVT and HPPOSLLH, station messages
+struct Epoch {
+    std::vector<uint8_t> stream;
+    std::vector<uint8_t> rtcm;
+    int rtcmFrames = 0;
+    int ubxFrames = 0;
+    int nmeaSentences = 0;
+
+    Epoch() {
+        add_nmea("GNGGA,123519.00,4807.03811,N,01131.00021,E,1,12,0.8,545.4,M,46.9,M,,");
+        add_rtcm(1077, 220);
+        add_ubx(0x01, 0x07, 92);
+        add_rtcm(1087, 180);
+        add_nmea("GNRMC,123519.00,A,4807.03811,N,01131.00021,E,0.02,,230394,,,A,V");
+        add_rtcm(1097, 200);
+        add_ubx(0x01, 0x14, 36);
+        add_rtcm(1127, 190);
+        add_rtcm(1005, 19);
+        add_rtcm(1230, 2);
+    }
+    void add_rtcm(const int msg_type, const size_t len) {
+        const std::vector<uint8_t> frame = rtcm_frame(msg_type, len);
+        append(stream, frame);
+        append(rtcm, frame);
+        rtcmFrames++;
+    }
+    void add_ubx(const uint8_t cls, const uint8_t id, const size_t len) {
+        append(stream, ubx_frame(cls, id, len));
+        ubxFrames++;
+    }
+    void add_nmea(const char *body) {
+        append(stream, nmea_sentence(body));
+        nmeaSentences++;
+    }
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void check_epoch(const Epoch &epoch, const Recorded &recorded, const Demux &demux) {
+    TEST_ASSERT_EQUAL_INT(epoch.rtcm.size(), recorded.rtcm.size());
+    TEST_ASSERT_EQUAL_MEMORY(epoch.rtcm.data(), recorded.rtcm.data(), epoch.rtcm.size());
+    TEST_ASSERT_EQUAL_INT(epoch.ubxFrames, recorded.ubx.size());
+    TEST_ASSERT_EQUAL_INT(epoch.nmeaSentences, recorded.nmea.size());
+    TEST_ASSERT_EQUAL_INT(0x07, recorded.ubx[0][3]);
+    TEST_ASSERT_EQUAL_INT(100, recorded.ubx[0].size());
+    TEST_ASSERT_TRUE(recorded.nmea[0].compare(0, 6, "$GNGGA") == 0);
+
+    const Demux::Stats &stats = demux.get_stats();
+    TEST_ASSERT_EQUAL_UINT32(epoch.rtcmFrames, stats.frames[Demux::RTCM]);
+    TEST_ASSERT_EQUAL_UINT32(epoch.ubxFrames, stats.frames[Demux::UBX]);
+    TEST_ASSERT_EQUAL_UINT32(epoch.nmeaSentences, stats.frames[Demux::NMEA]);
+    TEST_ASSERT_EQUAL_UINT32(epoch.stream.size(),
+                             stats.bytes[Demux::RTCM] + stats.bytes[Demux::UBX] + stats.bytes[Demux::NMEA]);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.bytes_skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.ubx_errors);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.nmea_errors);
+}
+
+void test_splits_interleaved_stream(void) {
+    const Epoch epoch;
+    Recorded recorded;
+    Demux demux{RecordingHandler(&recorded)};
+    demux.process(epoch.stream.data(), epoch.stream.size());
+    check_epoch(epoch, recorded, demux);
+}
+
+// The same result whatever the read sizes, down to one byte per read
+void test_any_read_size(void) {
+    const Epoch epoch;
+    const size_t sizes[] = {1, 2, 3, 5, 7, 64, 1000};
+    for (size_t size : sizes) {
+        Recorded recorded;
+        Demux demux{RecordingHandler(&recorded)};
+        for (size_t pos = 0; pos < epoch.stream.size(); pos += size) {
+            const size_t len = epoch.stream.size() - pos < size ? epoch.stream.size() - pos : size;
+            demux.process(&epoch.stream[pos], len);
+        }
+        check_epoch(epoch, recorded, demux);
+    }
+}
+
+struct CountingSink {
+    int *count;
+    explicit CountingSink(int *count = nullptr) : count(count) {}
+    void operator()(const uint8_t *, int) const { (*count)++; }
+};
+
+// RTCM runs feed an RtcmFramer as they come, every frame passes its CRC check
+void test_feeds_rtcm_framer(void) {
+    static int frames = 0;
+    struct FramerHandler {
+        RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, CountingSink> *framer;
+        void rtcm(const uint8_t *data, size_t len) const { framer->process_bytes(data, len); }
+        void ubx(const uint8_t *, size_t) const {}
+        void nmea(const uint8_t *, size_t) const {}
+    };
+    RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, CountingSink> framer{CountingSink(&frames)};
+    GnssDemux<256, 96, FramerHandler> demux{FramerHandler{&framer}};
+
+    const Epoch epoch;
+    for (int i = 0; i < 3; i++) {
+        for (size_t pos = 0; pos < epoch.stream.size(); pos += 37) {
+            const size_t len = epoch.stream.size() - pos < 37 ? epoch.stream.size() - pos : 37;
+            demux.process(&epoch.stream[pos], len);
+        }
+    }
+    // The empty 1230 is framed but not forwarded
+    TEST_ASSERT_EQUAL_INT(3 * (epoch.rtcmFrames - 1), frames);
+    TEST_ASSERT_EQUAL_UINT32(0, framer.get_stats().crc_errors);
+}
+
+// Garbage, false sync bytes and broken frames cost only themselves
+void test_recovers_from_bad_frames(void) {
+    const Epoch epoch;
+    std::vector<uint8_t> stream = {0x00, 0x42, 0xB5, 0x00, 0xD3, 0xFF, 0x00};  // Junk, B5 without 62, D3 with reserved bits
+    std::vector<uint8_t> badUbx = ubx_frame(0x01, 0x07, 92);
+    badUbx[50] ^= 0x01;
+    append(stream, badUbx);
+    append(stream, std::string("$GNGSA,A,3,,*00\r\n"));      // Wrong checksum
+    append(stream, std::string("$GNGSV,1,1,0"));             // Cut short by the next frame
+    std::vector<uint8_t> longUbx = {0xB5, 0x62, 0x01, 0x35, 0x00, 0x10};  // 4096 bytes, longer than the buffer
+    append(stream, longUbx);
+    append(stream, epoch.stream);
+
+    Recorded recorded;
+    Demux demux{RecordingHandler(&recorded)};
+    demux.process(stream.data(), stream.size());
+
+    TEST_ASSERT_EQUAL_INT(epoch.rtcm.size(), recorded.rtcm.size());
+    TEST_ASSERT_EQUAL_MEMORY(epoch.rtcm.data(), recorded.rtcm.data(), epoch.rtcm.size());
+    TEST_ASSERT_EQUAL_INT(epoch.ubxFrames, recorded.ubx.size());
+    TEST_ASSERT_EQUAL_INT(epoch.nmeaSentences, recorded.nmea.size());
+    const Demux::Stats &stats = demux.get_stats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.ubx_errors);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.nmea_errors);
+    TEST_ASSERT_EQUAL_UINT32(stream.size() - epoch.stream.size(), stats.bytes_skipped);
+}
+
+// A 0xD3 with a plausible header in front of a UBX frame fails its CRC and costs only its own bytes,
+// also when another false header inside the candidate fails in turn
+void test_false_rtcm_header_before_ubx(void) {
+    const Epoch epoch;
+    const std::vector<uint8_t> ubx = ubx_frame(0x01, 0x07, 92);
+    std::vector<uint8_t> stream = {0xD3, 0x00, 0x10};  // 22-byte candidate ending inside the UBX frame
+    append(stream, ubx);
+    const std::vector<uint8_t> nested = {0xD3, 0x00, 0x20, 0xD3, 0x00, 0x02};  // The second one ends first
+    append(stream, nested);
+    append(stream, ubx);
+    append(stream, epoch.stream);
+
+    const size_t sizes[] = {1, 7, 1000};
+    for (size_t size : sizes) {
+        Recorded recorded;
+        Demux demux{RecordingHandler(&recorded)};
+        for (size_t pos = 0; pos < stream.size(); pos += size) {
+            const size_t len = stream.size() - pos < size ? stream.size() - pos : size;
+            demux.process(&stream[pos], len);
+        }
+
+        TEST_ASSERT_EQUAL_INT(2 + epoch.ubxFrames, recorded.ubx.size());
+        TEST_ASSERT_EQUAL_INT(ubx.size(), recorded.ubx[0].size());
+        TEST_ASSERT_EQUAL_MEMORY(ubx.data(), recorded.ubx[0].data(), ubx.size());
+        TEST_ASSERT_EQUAL_MEMORY(ubx.data(), recorded.ubx[1].data(), ubx.size());
+        TEST_ASSERT_EQUAL_INT(epoch.rtcm.size(), recorded.rtcm.size());
+        TEST_ASSERT_EQUAL_MEMORY(epoch.rtcm.data(), recorded.rtcm.data(), epoch.rtcm.size());
+        const Demux::Stats &stats = demux.get_stats();
+        TEST_ASSERT_EQUAL_UINT32(3, stats.rtcm_errors);
+        TEST_ASSERT_EQUAL_UINT32(3 + nested.size(), stats.bytes_skipped);
+        TEST_ASSERT_EQUAL_UINT32(epoch.rtcmFrames, stats.frames[Demux::RTCM]);
+    }
+}
+
+// A damaged RTCM frame is dropped whole, the frame behind it still comes through
+void test_damaged_rtcm_frame(void) {
+    std::vector<uint8_t> damaged = rtcm_frame(1077, 120);
+    damaged[60] ^= 0x01;
+    const std::vector<uint8_t> good = rtcm_frame(1087, 100);
+    std::vector<uint8_t> stream = damaged;
+    append(stream, good);
+
+    Recorded recorded;
+    Demux demux{RecordingHandler(&recorded)};
+    demux.process(stream.data(), stream.size());
+
+    TEST_ASSERT_EQUAL_INT(good.size(), recorded.rtcm.size());
+    TEST_ASSERT_EQUAL_MEMORY(good.data(), recorded.rtcm.data(), good.size());
+    const Demux::Stats &stats = demux.get_stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.frames[Demux::RTCM]);
+    TEST_ASSERT_EQUAL_UINT32(damaged.size(), stats.bytes_skipped);
+}
+
+// A frame in progress when another reader took over is dropped, the next one is found
+void test_drop_partial(void) {
+    const Epoch epoch;
+    const std::vector<uint8_t> ubx = ubx_frame(0x01, 0x07, 92);
+    Recorded recorded;
+    Demux demux{RecordingHandler(&recorded)};
+    demux.process(ubx.data(), 40);
+    demux.drop_partial();
+    demux.process(epoch.stream.data(), epoch.stream.size());
+    TEST_ASSERT_EQUAL_INT(epoch.ubxFrames, recorded.ubx.size());
+    TEST_ASSERT_EQUAL_INT(epoch.rtcm.size(), recorded.rtcm.size());
+}
+
+struct NullHandler {
+    void rtcm(const uint8_t *, size_t) const {}
+    void ubx(const uint8_t *, size_t) const {}
+    void nmea(const uint8_t *, size_t) const {}
+};
+
+// Demultiplexing cost per byte of a typical stream (printed, not asserted)
+void test_benchmark_per_byte(void) {
+    const Epoch epoch;
+    GnssDemux<256, 96, NullHandler> demux;
+    const int rounds = 20000;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        for (size_t pos = 0; pos < epoch.stream.size(); pos += 256) {
+            const size_t len = epoch.stream.size() - pos < 256 ? epoch.stream.size() - pos : 256;
+            demux.process(&epoch.stream[pos], len);
+        }
+    }
+    const double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)epoch.rtcmFrames * rounds, demux.get_stats().frames[decltype(demux)::RTCM]);
+
+    char message[128];
+    snprintf(message, sizeof(message), "demux: %.2f ns/byte over a %d B epoch", elapsed_ns / rounds / epoch.stream.size(),
+             (int)epoch.stream.size());
+    TEST_MESSAGE(message);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_splits_interleaved_stream);
+    RUN_TEST(test_any_read_size);
+    RUN_TEST(test_feeds_rtcm_framer);
+    RUN_TEST(test_recovers_from_bad_frames);
+    RUN_TEST(test_false_rtcm_header_before_ubx);
+    RUN_TEST(test_damaged_rtcm_frame);
+    RUN_TEST(test_drop_partial);
+    RUN_TEST(test_benchmark_per_byte);
+
+    return UNITY_END();
+}
@@ -0,0 +1,259 @@
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "network/msm.h"
+#include "network/rtcm_encoder.h"
+#include "network/rtcmbuffer.h"
+
+// GPS 1077 from station 2003, TOW 123456.789 s, multiple message bit set,
+// satellites 3, 7, 12 on signals 2 and 16, satellite 12 without signal 16.
+// The five cells cover the edge cases: invalid pseudorange and phaserange,
+// rounding both ways, the largest values, lock times 0 / 50 / 100 / 704 / 300
+// and CNR 0 (not computed) to 1023 (63.94 dB-Hz).
+static const uint8_t REFERENCE_1077[] = {
+    0xD3, 0x00, 0x56, 0x43, 0x57, 0xD3, 0x1D, 0x6F, 0x34, 0x56, 0xC0, 0x20, 0x11,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x80, 0x00, 0x7C, 0x8C,
+    0x96, 0xA0, 0x00, 0x00, 0x0C, 0x01, 0xFF, 0xC0, 0x02, 0x03, 0x27, 0xF3, 0x90,
+    0x00, 0x00, 0x06, 0x07, 0x3F, 0x9F, 0x8E, 0xFF, 0xFF, 0xE0, 0x00, 0x21, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x05, 0xFF, 0xFF, 0xFC, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFA, 0x00, 0x06, 0x43, 0x25, 0x80, 0x96, 0x2C, 0x00, 0xAF, 0x33, 0x7F, 0xFC,
+    0x08, 0x00, 0x03, 0xFF, 0xFD, 0xFF, 0xFC, 0x00, 0x00, 0x00, 0x00, 0xE9, 0x47,
+    0x2C
+};
+
+// The same epoch as 1074, encoded independently from the field values
+static const uint8_t REFERENCE_1074[] = {
+    0xD3, 0x00, 0x3B, 0x43, 0x27, 0xD3, 0x1D, 0x6F, 0x34, 0x56, 0xC0, 0x20, 0x11,
+    0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x00, 0x80, 0x00, 0x7C, 0x8C,
+    0x96, 0xA0, 0x00, 0xC0, 0x1F, 0xFC, 0x00, 0x00, 0x30, 0x5F, 0x9F, 0x9F, 0xFF,
+    0x80, 0x01, 0x80, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x1F, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFC, 0x04, 0xFE, 0x56, 0x05, 0x99, 0xFE, 0x08, 0x5E, 0xDE, 0x48
+};
+
+// A full MSM7 frame: sats x signals cells, all set, pseudo-random field values
+static std::vector<uint8_t> make_msm7(const int msg_type, const int sats, const int signals,
+                                      const uint32_t epoch_time = 123456789, const bool more = false) {
+    std::vector<uint8_t> frame(rtcmbuffer::MAX_FRAME_LEN, 0);
+    rtcm_encoder::BitWriter bits(&frame[3]);
+    bits.put(msg_type, 12);
+    bits.put(2003, 12);
+    bits.put(epoch_time, 30);
+    bits.put(more, 1);
+    bits.put(0, 3 + 7 + 2 + 2 + 1 + 3);
+    bits.put((~0ULL) << (64 - sats), 64);
+    bits.put((uint32_t)(~0ULL << (32 - signals)), 32);
+    for (int i = 0; i < sats * signals; i++) {
+        bits.put(1, 1);
+    }
+    uint32_t seed = 12345;
+    const int cells = sats * signals;
+    const int widths[] = {8, 4, 10, 14};
+    for (int width : widths) {
+        for (int i = 0; i < sats; i++) {
+            seed = seed * 1103515245 + 12345;
+            bits.put(seed >> 8, width);
+        }
+    }
+    const int cellWidths[] = {20, 24, 10, 1, 10, 15};
+    for (int width : cellWidths) {
+        for (int i = 0; i < cells; i++) {
+            seed = seed * 1103515245 + 12345;
+            bits.put(seed >> 8, width);
+        }
+    }
+    const size_t len = rtcm_encoder::finish_frame(&frame[0], (bits.bits_written() + 7) / 8);
+    frame.resize(len);
+    return frame;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_matches_reference(void) {
+    uint8_t out[sizeof(REFERENCE_1077)];
+    const size_t len = msm::msm7_to_msm4(REFERENCE_1077, sizeof(REFERENCE_1077), out);
+    TEST_ASSERT_EQUAL_INT(sizeof(REFERENCE_1074), (int)len);
+    TEST_ASSERT_EQUAL_MEMORY(REFERENCE_1074, out, sizeof(REFERENCE_1074));
+}
+
+// The output is a valid frame with the same layout and epoch bits
+void test_layout_preserved(void) {
+    msm::Layout in;
+    msm::Layout out;
+    uint8_t frame[sizeof(REFERENCE_1077)];
+    const size_t len = msm::msm7_to_msm4(REFERENCE_1077, sizeof(REFERENCE_1077), frame);
+    TEST_ASSERT_TRUE(msm::parse_layout(REFERENCE_1077 + 3, sizeof(REFERENCE_1077) - 6, in));
+    TEST_ASSERT_TRUE(msm::parse_layout(frame + 3, len - 6, out));
+    TEST_ASSERT_EQUAL_INT(1077, in.msg_type);
+    TEST_ASSERT_EQUAL_INT(1074, out.msg_type);
+    TEST_ASSERT_EQUAL_INT(3, out.sats);
+    TEST_ASSERT_EQUAL_INT(2, out.signals);
+    TEST_ASSERT_EQUAL_INT(5, out.cells);
+    TEST_ASSERT_EQUAL_UINT32(crc24q::compute(frame, len - 3),
+                             ((uint32_t)frame[len - 3] << 16) | (frame[len - 2] << 8) | frame[len - 1]);
+    TEST_ASSERT_FALSE(rtcmbuffer::is_epoch_end(frame, len));
+}
+
+// Every constellation and the largest cell mask
+void test_all_constellations(void) {
+    for (int msg_type = 1077; msg_type <= 1137; msg_type += 10) {
+        const std::vector<uint8_t> msm7 = make_msm7(msg_type, 16, 4);
+        std::vector<uint8_t> out(msm7.size());
+        const size_t len = msm::msm7_to_msm4(msm7.data(), msm7.size(), out.data());
+        msm::Layout layout;
+        TEST_ASSERT_TRUE(msm::parse_layout(&out[3], len - 6, layout));
+        TEST_ASSERT_EQUAL_INT(msg_type - 3, layout.msg_type);
+        TEST_ASSERT_EQUAL_INT(64, layout.cells);
+        TEST_ASSERT_EQUAL_INT((layout.payload_bits + 7) / 8 + 6, (int)len);
+        // Satellite data is 18 of 36 bits, cell data 48 of 80 bits
+        TEST_ASSERT_TRUE(len < msm7.size() * 2 / 3);
+    }
+}
+
+void test_decode_header(void) {
+    msm::Header header;
+    TEST_ASSERT_TRUE(msm::decode_header(REFERENCE_1077 + 3, sizeof(REFERENCE_1077) - 6, header));
+    TEST_ASSERT_EQUAL_INT(1077, header.msg_type);
+    TEST_ASSERT_EQUAL_UINT16(2003, header.station_id);
+    TEST_ASSERT_EQUAL_UINT32(123456789, header.epoch_time);
+    TEST_ASSERT_TRUE(header.multiple_message);
+    TEST_ASSERT_EQUAL_INT(3, header.sats);
+    TEST_ASSERT_EQUAL_INT(2, header.signals);
+    TEST_ASSERT_EQUAL_INT(5, header.cells);
+
+    // Only the header has to be there
+    TEST_ASSERT_TRUE(msm::decode_header(REFERENCE_1077 + 3, 30, header));
+    TEST_ASSERT_FALSE(msm::decode_header(REFERENCE_1077 + 3, 21, header));
+    uint8_t payload[32] = {0x3E, 0xD0};  // 1005
+    TEST_ASSERT_FALSE(msm::decode_header(payload, sizeof(payload), header));
+}
+
+// Per-constellation counts and epoch completeness from the headers alone
+void test_stream_stats(void) {
+    msm::StreamStats stats;
+    const std::vector<uint8_t> gps = make_msm7(1077, 10, 2, 1000, true);
+    const std::vector<uint8_t> galileo = make_msm7(1097, 6, 2, 1000, true);
+    const std::vector<uint8_t> beidou = make_msm7(1127, 8, 3, 1000, false);
+    stats.add(gps.data(), gps.size());
+    stats.add(galileo.data(), galileo.size());
+    stats.add(beidou.data(), beidou.size());
+    TEST_ASSERT_EQUAL_UINT32(1, stats.complete_epochs());
+    TEST_ASSERT_EQUAL_INT(3, stats.constellations_per_epoch());
+    TEST_ASSERT_EQUAL_INT(10, stats.constellation(0).sats);
+    TEST_ASSERT_EQUAL_INT(20, stats.constellation(0).cells);
+    TEST_ASSERT_EQUAL_INT(24, stats.constellation(5).cells);
+    TEST_ASSERT_EQUAL_INT(0, stats.constellation(1).msg_type);
+
+    // Two GPS frames in one epoch add up
+    const std::vector<uint8_t> gps2 = make_msm7(1077, 4, 2, 2000, true);
+    const std::vector<uint8_t> gps3 = make_msm7(1077, 4, 2, 2000, true);
+    stats.add(gps2.data(), gps2.size());
+    stats.add(gps3.data(), gps3.size());
+    TEST_ASSERT_EQUAL_INT(8, stats.constellation(0).sats);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.constellation(0).epochs);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.constellation(0).frames);
+
+    // The epoch end is lost: the next GPS epoch marks it incomplete
+    const std::vector<uint8_t> gps4 = make_msm7(1077, 9, 2, 3000, false);
+    stats.add(gps4.data(), gps4.size());
+    TEST_ASSERT_EQUAL_UINT32(1, stats.incomplete_epochs());
+    TEST_ASSERT_EQUAL_UINT32(2, stats.complete_epochs());
+    TEST_ASSERT_EQUAL_INT(1, stats.constellations_per_epoch());
+    TEST_ASSERT_EQUAL_INT(9, stats.constellation(0).sats);
+
+    // Non-MSM frames don't count
+    uint8_t arp[rtcm_encoder::MSG_1005_LEN];
+    rtcm_encoder::StationPosition position = {1, 0, 0, 0, 0, true, false, false};
+    stats.add(arp, rtcm_encoder::encode_1005(position, arp));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.complete_epochs());
+}
+
+void test_lock_time_indicator(void) {
+    TEST_ASSERT_EQUAL_UINT8(0, msm::lock_time_indicator(0));
+    TEST_ASSERT_EQUAL_UINT8(0, msm::lock_time_indicator(31));
+    TEST_ASSERT_EQUAL_UINT8(1, msm::lock_time_indicator(32));
+    TEST_ASSERT_EQUAL_UINT8(1, msm::lock_time_indicator(63));
+    TEST_ASSERT_EQUAL_UINT8(2, msm::lock_time_indicator(64));   // 64 ms
+    TEST_ASSERT_EQUAL_UINT8(3, msm::lock_time_indicator(96));   // 128 ms
+    TEST_ASSERT_EQUAL_UINT8(9, msm::lock_time_indicator(300));  // 11264 ms
+    TEST_ASSERT_EQUAL_UINT8(15, msm::lock_time_indicator(512)); // 524288 ms
+    TEST_ASSERT_EQUAL_UINT8(15, msm::lock_time_indicator(704));
+    TEST_ASSERT_EQUAL_UINT8(15, msm::lock_time_indicator(1023));
+}
+
+void test_rejects_other_frames(void) {
+    uint8_t out[rtcmbuffer::MAX_FRAME_LEN];
+    // Other MSM and non-MSM types
+    const std::vector<uint8_t> msm4 = make_msm7(1074, 4, 2);
+    TEST_ASSERT_EQUAL_INT(0, (int)msm::msm7_to_msm4(msm4.data(), msm4.size(), out));
+    uint8_t arp[rtcm_encoder::MSG_1005_LEN];
+    rtcm_encoder::StationPosition position = {1, 0, 0, 0, 0, true, false, false};
+    TEST_ASSERT_EQUAL_INT(0, (int)msm::msm7_to_msm4(arp, rtcm_encoder::encode_1005(position, arp), out));
+    // Truncated: the length field is longer than the frame, or shorter than the masks announce
+    const std::vector<uint8_t> msm7 = make_msm7(1077, 4, 2);
+    TEST_ASSERT_EQUAL_INT(0, (int)msm::msm7_to_msm4(msm7.data(), msm7.size() - 1, out));
+    std::vector<uint8_t> shortened = msm7;
+    shortened[2] -= 2;
+    TEST_ASSERT_EQUAL_INT(0, (int)msm::msm7_to_msm4(shortened.data(), shortened.size(), out));
+}
+
+// Keeps the benchmark loop from being optimised away
+static volatile size_t bench_sink = 0;
+
+void test_benchmark_per_frame(void) {
+    const std::vector<uint8_t> small = make_msm7(1077, 8, 2);
+    const std::vector<uint8_t> large = make_msm7(1077, 16, 4);
+    uint8_t out[rtcmbuffer::MAX_FRAME_LEN];
+    const int iterations = 20000;
+    double us[2];
+    const std::vector<uint8_t> *frames[] = {&small, &large};
+    for (int f = 0; f < 2; f++) {
+        size_t acc = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            acc += msm::msm7_to_msm4(frames[f]->data(), frames[f]->size(), out);
+        }
+        auto end = std::chrono::steady_clock::now();
+        bench_sink += acc;
+        us[f] = std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+    }
+
+    // Header decoding, as done for every frame
+    msm::Header header;
+    size_t cells = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        msm::decode_header(&large[3], large.size() - 6, header);
+        cells += header.cells;
+    }
+    auto end = std::chrono::steady_clock::now();
+    bench_sink += cells;
+    const double header_ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+
+    char msg[200];
+    snprintf(msg, sizeof(msg), "MSM7->MSM4: %u B (16 cells) %.2f us/frame, %u B (64 cells) %.2f us/frame; "
+             "header decode %.0f ns/frame",
+             (unsigned)small.size(), us[0], (unsigned)large.size(), us[1], header_ns);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_TRUE(us[0] > 0 && us[1] > 0 && header_ns > 0);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_matches_reference);
+    RUN_TEST(test_layout_preserved);
+    RUN_TEST(test_all_constellations);
+    RUN_TEST(test_decode_header);
+    RUN_TEST(test_stream_stats);
+    RUN_TEST(test_lock_time_indicator);
+    RUN_TEST(test_rejects_other_frames);
+    RUN_TEST(test_benchmark_per_frame);
+
+    return UNITY_END();
+}
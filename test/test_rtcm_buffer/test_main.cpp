@@ -21,13 +21,20 @@ void reset_mock() {
     forwarded.clear();
 }
 
-#include "rtcmbuffer.h"
+#include "network/rtcmbuffer.h"
+
+struct MockSink {
+    void operator()(const uint8_t* data, int len) const { mock_forward_func(data, len); }
+};
+
+// Framer under test: the production template, fed like the UART stream
+static RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, MockSink> framer;
 
 // ----- CRC24Q reference (independent of buffer module) -----
 // Polynomial 0x1864CFB. Same algorithm as production, used here to build
 // known-good messages for tests. Keeping a separate implementation avoids
 // the test trivially asserting "module agrees with itself".
-static uint32_t crc24q(const uint8_t* data, int len) {
+static uint32_t crc24q_reference(const uint8_t* data, int len) {
     uint32_t crc = 0;
     for (int i = 0; i < len; i++) {
         crc ^= ((uint32_t)data[i]) << 16;
@@ -56,7 +63,7 @@ static std::vector<uint8_t> build_rtcm(int msg_type, const uint8_t* payload_tail
     for (int i = 2; i < payload_len; i++) {
         frame[3 + i] = payload_tail ? payload_tail[i - 2] : 0x00;
     }
-    uint32_t crc = crc24q(frame.data(), 3 + payload_len);
+    uint32_t crc = crc24q_reference(frame.data(), 3 + payload_len);
     frame[3 + payload_len + 0] = (crc >> 16) & 0xFF;
     frame[3 + payload_len + 1] = (crc >>  8) & 0xFF;
     frame[3 + payload_len + 2] = (crc >>  0) & 0xFF;
@@ -64,11 +71,19 @@ static std::vector<uint8_t> build_rtcm(int msg_type, const uint8_t* payload_tail
 }
 
 static void feed(const std::vector<uint8_t>& bytes) {
-    for (uint8_t b : bytes) rtcmbuffer::process_byte(b, mock_forward_func);
+    for (uint8_t b : bytes) framer.process_byte(b);
+}
+
+// Feed a byte stream through the bulk path in reads of at most `chunk` bytes.
+static void feed_bulk(const std::vector<uint8_t>& bytes, size_t chunk) {
+    for (size_t pos = 0; pos < bytes.size(); pos += chunk) {
+        size_t n = bytes.size() - pos < chunk ? bytes.size() - pos : chunk;
+        framer.process_bytes(bytes.data() + pos, n);
+    }
 }
 
 void setUp(void) {
-    rtcmbuffer::init();
+    framer.reset();
     reset_mock();
 }
 
@@ -83,6 +98,25 @@ void test_message_type_extraction(void) {
     TEST_ASSERT_EQUAL_INT(1005, rtcmbuffer::get_rtcm_message_type(payload));
 }
 
+// Multiple message bit is payload bit 54 of the MSM header
+void test_epoch_end_from_multiple_message_bit(void) {
+    uint8_t tail[20] = {0};
+    auto last = build_rtcm(1077, tail, 22);
+    TEST_ASSERT_TRUE(rtcmbuffer::is_epoch_end(last.data(), last.size()));
+
+    tail[4] = 0x02;  // payload byte 6, bit 1
+    auto more = build_rtcm(1127, tail, 22);
+    TEST_ASSERT_FALSE(rtcmbuffer::is_epoch_end(more.data(), more.size()));
+
+    // Non-MSM messages never end an epoch
+    auto station = build_rtcm(1005, nullptr, 19);
+    TEST_ASSERT_FALSE(rtcmbuffer::is_epoch_end(station.data(), station.size()));
+    TEST_ASSERT_TRUE(rtcmbuffer::is_msm(1137));
+    TEST_ASSERT_FALSE(rtcmbuffer::is_msm(1070));
+    TEST_ASSERT_FALSE(rtcmbuffer::is_msm(1078));
+    TEST_ASSERT_FALSE(rtcmbuffer::is_msm(1230));
+}
+
 void test_length_parsing(void) {
     uint8_t header[] = {0xD3, 0x00, 0x06};
     TEST_ASSERT_EQUAL_INT(6, rtcmbuffer::parse_rtcm_length(header));
@@ -142,9 +176,9 @@ void test_crc_mismatch_not_forwarded(void) {
 // (5) After buffer overflow / reset, a subsequent valid message still parses.
 void test_resync_after_overflow(void) {
     // Start a message but never finish it; then send junk to force overflow.
-    rtcmbuffer::process_byte(0xD3, mock_forward_func);
+    framer.process_byte(0xD3);
     for (int i = 0; i < 1100; i++) {
-        rtcmbuffer::process_byte(0xAA, mock_forward_func);
+        framer.process_byte(0xAA);
     }
     TEST_ASSERT_EQUAL_INT(0, (int)forwarded.size());
 
@@ -185,19 +219,257 @@ void test_rtcm_1230_long_forwarded(void) {
 // ===== Existing structural tests =====
 
 void test_buffer_overflow_protection(void) {
-    rtcmbuffer::process_byte(0xD3, mock_forward_func);
+    framer.process_byte(0xD3);
     for (int i = 0; i < 1100; i++) {
-        rtcmbuffer::process_byte(0xFF, mock_forward_func);
+        framer.process_byte(0xFF);
     }
     TEST_ASSERT_EQUAL_INT(0, (int)forwarded.size());
 }
 
 void test_invalid_length_rejected(void) {
     uint8_t bad[] = {0xD3, 0xFF, 0xFF};  // 4095 > 1023
-    for (auto b : bad) rtcmbuffer::process_byte(b, mock_forward_func);
+    for (auto b : bad) framer.process_byte(b);
+    TEST_ASSERT_EQUAL_INT(0, (int)forwarded.size());
+}
+
+// ===== Bulk (process_bytes) path =====
+
+// A whole frame in one read is forwarded unchanged.
+void test_bulk_single_read(void) {
+    auto frame = build_rtcm(1077, nullptr, 1023);
+    feed_bulk(frame, frame.size());
+    TEST_ASSERT_EQUAL_INT(1, (int)forwarded.size());
+    TEST_ASSERT_EQUAL_MEMORY(frame.data(), forwarded[0].data.data(), frame.size());
+}
+
+// Frames split at every possible read size, including inside the header.
+void test_bulk_split_reads(void) {
+    auto a = build_rtcm(1005, nullptr, 19);
+    auto b = build_rtcm(1087, nullptr, 300);
+    std::vector<uint8_t> stream(a);
+    stream.insert(stream.end(), b.begin(), b.end());
+    const size_t chunks[] = {1, 2, 3, 4, 7, 64, 257};
+    for (size_t i = 0; i < sizeof(chunks)/sizeof(chunks[0]); i++) {
+        framer.reset();
+        reset_mock();
+        feed_bulk(stream, chunks[i]);
+        char msg[64];
+        snprintf(msg, sizeof(msg), "chunk=%u", (unsigned)chunks[i]);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(2, (int)forwarded.size(), msg);
+        TEST_ASSERT_EQUAL_MEMORY(a.data(), forwarded[0].data.data(), a.size());
+        TEST_ASSERT_EQUAL_MEMORY(b.data(), forwarded[1].data.data(), b.size());
+    }
+}
+
+// Non-RTCM bytes between frames (UBX/NMEA leftovers) are skipped.
+void test_bulk_skips_garbage_between_frames(void) {
+    auto a = build_rtcm(1097, nullptr, 40);
+    auto b = build_rtcm(1127, nullptr, 40);
+    std::vector<uint8_t> stream = {0xB5, 0x62, 0x01, 0x07, '$', 'G', 'N'};
+    stream.insert(stream.end(), a.begin(), a.end());
+    stream.insert(stream.end(), 50, 0x00);
+    stream.insert(stream.end(), b.begin(), b.end());
+    feed_bulk(stream, stream.size());
+    TEST_ASSERT_EQUAL_INT(2, (int)forwarded.size());
+    TEST_ASSERT_EQUAL_INT((int)a.size(), (int)forwarded[0].data.size());
+    TEST_ASSERT_EQUAL_INT((int)b.size(), (int)forwarded[1].data.size());
+}
+
+void test_bulk_crc_mismatch_not_forwarded(void) {
+    auto frame = build_rtcm(1005, nullptr, 6);
+    frame.back() ^= 0xFF;
+    feed_bulk(frame, frame.size());
+    TEST_ASSERT_EQUAL_INT(0, (int)forwarded.size());
+}
+
+// The bulk path applies the same 1230 filter as the bytewise path.
+void test_bulk_rtcm_1230_short_filtered(void) {
+    auto frame = build_rtcm(1230, nullptr, 2);
+    feed_bulk(frame, frame.size());
     TEST_ASSERT_EQUAL_INT(0, (int)forwarded.size());
 }
 
+// ===== Lossless resync =====
+
+// A frame truncated by a UART overrun swallows the following frames as its
+// "payload". After the CRC fails, the buffered bytes must be rescanned so the
+// swallowed frames are still forwarded.
+static std::vector<uint8_t> truncated_then_valid(std::vector<uint8_t>& b, std::vector<uint8_t>& c) {
+    auto bogus = build_rtcm(1077, nullptr, 200);
+    b = build_rtcm(1005, nullptr, 19);
+    c = build_rtcm(1087, nullptr, 300);
+    std::vector<uint8_t> stream(bogus.begin(), bogus.begin() + 23);  // Truncated after 20 payload bytes
+    stream.insert(stream.end(), b.begin(), b.end());
+    stream.insert(stream.end(), c.begin(), c.end());
+    return stream;
+}
+
+void test_resync_recovers_swallowed_frames_bytewise(void) {
+    std::vector<uint8_t> b, c;
+    feed(truncated_then_valid(b, c));
+    TEST_ASSERT_EQUAL_INT_MESSAGE(2, (int)forwarded.size(), "swallowed frames were not recovered");
+    TEST_ASSERT_EQUAL_MEMORY(b.data(), forwarded[0].data.data(), b.size());
+    TEST_ASSERT_EQUAL_MEMORY(c.data(), forwarded[1].data.data(), c.size());
+    TEST_ASSERT_EQUAL_UINT32(1, framer.get_stats().crc_errors);
+    TEST_ASSERT_EQUAL_UINT32(23, framer.get_stats().bytes_skipped);
+    TEST_ASSERT_EQUAL_UINT32(2, framer.get_stats().frames_recovered);
+}
+
+void test_resync_recovers_swallowed_frames_bulk(void) {
+    std::vector<uint8_t> b, c;
+    auto stream = truncated_then_valid(b, c);
+    const size_t chunks[] = {1, 5, 64, 1024};
+    for (size_t i = 0; i < sizeof(chunks)/sizeof(chunks[0]); i++) {
+        framer.reset();
+        reset_mock();
+        feed_bulk(stream, chunks[i]);
+        char msg[64];
+        snprintf(msg, sizeof(msg), "chunk=%u", (unsigned)chunks[i]);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(2, (int)forwarded.size(), msg);
+        TEST_ASSERT_EQUAL_MEMORY(b.data(), forwarded[0].data.data(), b.size());
+        TEST_ASSERT_EQUAL_MEMORY(c.data(), forwarded[1].data.data(), c.size());
+        TEST_ASSERT_EQUAL_UINT32(23, framer.get_stats().bytes_skipped);
+        TEST_ASSERT_EQUAL_UINT32(2, framer.get_stats().frames_recovered);
+    }
+}
+
+// Non-zero reserved header bits are rejected right after the header.
+void test_resync_after_bad_header(void) {
+    auto frame = build_rtcm(1005, nullptr, 6);
+    std::vector<uint8_t> stream = {0xD3, 0xFC, 0x10};
+    stream.insert(stream.end(), frame.begin(), frame.end());
+    feed(stream);
+    TEST_ASSERT_EQUAL_INT(1, (int)forwarded.size());
+    TEST_ASSERT_EQUAL_UINT32(1, framer.get_stats().length_errors);
+    TEST_ASSERT_EQUAL_UINT32(3, framer.get_stats().bytes_skipped);
+}
+
+// Valid frames mixed with junk containing false preambles: every frame must
+// come out, in order, through both paths and any read size.
+void test_resync_random_junk_lossless(void) {
+    std::vector<std::vector<uint8_t> > frames;
+    std::vector<uint8_t> stream;
+    uint32_t seed = 0x2545F491;
+    for (int f = 0; f < 40; f++) {
+        // Junk run, biased towards 0xD3 and header-looking bytes
+        seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+        int junk = seed % 24;
+        for (int j = 0; j < junk; j++) {
+            seed ^= seed << 13; seed ^= seed >> 17; seed ^= seed << 5;
+            uint8_t v = (seed & 3) == 0 ? 0xD3 : (uint8_t)((seed >> 8) & 0x03);
+            stream.push_back(v);
+        }
+        std::vector<uint8_t> tail(400);
+        for (size_t k = 0; k < tail.size(); k++) tail[k] = (uint8_t)(f * 7 + k);
+        frames.push_back(build_rtcm(1074 + f, tail.data(), 10 + (f * 37) % 390));
+        stream.insert(stream.end(), frames.back().begin(), frames.back().end());
+    }
+    // Enough idle bytes to flush any false frame still waiting for its length
+    stream.insert(stream.end(), 1100, 0x00);
+
+    const size_t chunks[] = {0, 1, 13, 256};
+    for (size_t i = 0; i < sizeof(chunks)/sizeof(chunks[0]); i++) {
+        framer.reset();
+        reset_mock();
+        if (chunks[i] == 0) {
+            feed(stream);
+        } else {
+            feed_bulk(stream, chunks[i]);
+        }
+        char msg[64];
+        snprintf(msg, sizeof(msg), "chunk=%u", (unsigned)chunks[i]);
+        TEST_ASSERT_EQUAL_INT_MESSAGE((int)frames.size(), (int)forwarded.size(), msg);
+        for (size_t f = 0; f < frames.size(); f++) {
+            TEST_ASSERT_EQUAL_INT((int)frames[f].size(), (int)forwarded[f].data.size());
+            TEST_ASSERT_EQUAL_MEMORY(frames[f].data(), forwarded[f].data.data(), frames[f].size());
+        }
+    }
+}
+
+// ===== Independent instances =====
+
+struct CountingSink {
+    int* count;
+    CountingSink(int* c = nullptr) : count(c) {}
+    void operator()(const uint8_t*, int) const { (*count)++; }
+};
+
+// Two framers fed interleaved bytes keep separate state and counters.
+void test_instances_are_independent(void) {
+    int count_a = 0, count_b = 0;
+    RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, CountingSink> a{CountingSink(&count_a)};
+    RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, CountingSink> b{CountingSink(&count_b)};
+    auto fa = build_rtcm(1005, nullptr, 19);
+    auto fb = build_rtcm(1077, nullptr, 300);
+    fb.back() ^= 0x01;  // Only stream b sees a CRC error
+    for (size_t i = 0; i < fb.size(); i++) {
+        if (i < fa.size()) a.process_byte(fa[i]);
+        b.process_byte(fb[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(1, count_a);
+    TEST_ASSERT_EQUAL_INT(0, count_b);
+    TEST_ASSERT_EQUAL_UINT32(0, a.get_stats().crc_errors);
+    TEST_ASSERT_EQUAL_UINT32(1, b.get_stats().crc_errors);
+}
+
+// A framer with a smaller MaxFrameLen rejects frames that don't fit at the header.
+void test_max_frame_len_caps_frames(void) {
+    int count = 0;
+    RtcmFramer<64, CountingSink> small{CountingSink(&count)};
+    auto fits = build_rtcm(1005, nullptr, 58);     // 64 bytes total
+    auto too_big = build_rtcm(1077, nullptr, 59);  // 65 bytes total
+    small.process_bytes(too_big.data(), too_big.size());
+    small.process_bytes(fits.data(), fits.size());
+    TEST_ASSERT_EQUAL_INT(1, count);
+    TEST_ASSERT_EQUAL_UINT32(1, small.get_stats().length_errors);
+}
+
+// ===== External storage hand-off (set_buffer) =====
+
+// Sink that takes ownership of each frame's storage and moves the framer to
+// the next buffer, like the frame pool does in production.
+struct HandoffSink;
+typedef RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, HandoffSink> HandoffFramer;
+static HandoffFramer* handoff_framer = nullptr;
+static uint8_t handoff_buffers[4][rtcmbuffer::MAX_FRAME_LEN];
+static int handoff_next = 0;
+static std::vector<const uint8_t*> handoff_frames;
+
+struct HandoffSink {
+    void operator()(const uint8_t* data, int len) const {
+        mock_forward_func(data, len);
+        handoff_frames.push_back(data);
+        handoff_next = (handoff_next + 1) % 4;
+        handoff_framer->set_buffer(handoff_buffers[handoff_next]);
+    }
+};
+
+// Frames are forwarded straight from the external buffers, and bytes after a
+// recovered frame survive the buffer switch during resync.
+void test_set_buffer_handoff_zero_copy(void) {
+    HandoffFramer f;
+    handoff_framer = &f;
+    handoff_next = 0;
+    handoff_frames.clear();
+    f.set_buffer(handoff_buffers[0]);
+
+    std::vector<uint8_t> b, c;
+    auto stream = truncated_then_valid(b, c);
+    auto d = build_rtcm(1097, nullptr, 50);
+    stream.insert(stream.end(), d.begin(), d.end());
+    f.process_bytes(stream.data(), stream.size());
+
+    TEST_ASSERT_EQUAL_INT(3, (int)forwarded.size());
+    TEST_ASSERT_EQUAL_MEMORY(b.data(), forwarded[0].data.data(), b.size());
+    TEST_ASSERT_EQUAL_MEMORY(c.data(), forwarded[1].data.data(), c.size());
+    TEST_ASSERT_EQUAL_MEMORY(d.data(), forwarded[2].data.data(), d.size());
+    // Each frame was handed out from the buffer it was assembled in
+    TEST_ASSERT_EQUAL_PTR(handoff_buffers[0], handoff_frames[0]);
+    TEST_ASSERT_EQUAL_PTR(handoff_buffers[1], handoff_frames[1]);
+    TEST_ASSERT_EQUAL_PTR(handoff_buffers[2], handoff_frames[2]);
+    handoff_framer = nullptr;
+}
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
 
@@ -217,5 +489,21 @@ int main(int argc, char **argv) {
     RUN_TEST(test_buffer_overflow_protection);
     RUN_TEST(test_invalid_length_rejected);
 
+    RUN_TEST(test_bulk_single_read);
+    RUN_TEST(test_bulk_split_reads);
+    RUN_TEST(test_bulk_skips_garbage_between_frames);
+    RUN_TEST(test_bulk_crc_mismatch_not_forwarded);
+    RUN_TEST(test_bulk_rtcm_1230_short_filtered);
+
+    RUN_TEST(test_resync_recovers_swallowed_frames_bytewise);
+    RUN_TEST(test_resync_recovers_swallowed_frames_bulk);
+    RUN_TEST(test_resync_after_bad_header);
+    RUN_TEST(test_resync_random_junk_lossless);
+
+    RUN_TEST(test_instances_are_independent);
+    RUN_TEST(test_max_frame_len_caps_frames);
+    RUN_TEST(test_set_buffer_handoff_zero_copy);
+    RUN_TEST(test_epoch_end_from_multiple_message_bit);
+
     return UNITY_END();
 }
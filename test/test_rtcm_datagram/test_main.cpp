@@ -0,0 +1,53 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "network/rtcm_datagram.h"
+
+using namespace rtcm_datagram;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_header_round_trip(void) {
+    uint8_t datagram[HEADER_LEN];
+    encode_header(datagram, 0x12345678, FLAG_EPOCH_END);
+
+    const uint8_t expected[HEADER_LEN] = {'R', 'T', VERSION, FLAG_EPOCH_END, 0x12, 0x34, 0x56, 0x78};
+    TEST_ASSERT_EQUAL_MEMORY(expected, datagram, HEADER_LEN);
+
+    Header header;
+    TEST_ASSERT_TRUE(decode_header(datagram, sizeof(datagram), header));
+    TEST_ASSERT_EQUAL_UINT8(VERSION, header.version);
+    TEST_ASSERT_EQUAL_UINT8(FLAG_EPOCH_END, header.flags);
+    TEST_ASSERT_EQUAL_UINT32(0x12345678, header.sequence);
+}
+
+// Short datagrams and other traffic on the port are rejected
+void test_decode_rejects_foreign_data(void) {
+    uint8_t datagram[HEADER_LEN];
+    encode_header(datagram, 1, 0);
+    Header header;
+    TEST_ASSERT_FALSE(decode_header(datagram, HEADER_LEN - 1, header));
+
+    const uint8_t rtcm[HEADER_LEN] = {0xD3, 0x00, 0x13, 0x3E, 0xD0, 0x00, 0x03, 0x00};
+    TEST_ASSERT_FALSE(decode_header(rtcm, sizeof(rtcm), header));
+}
+
+void test_loss_across_wrap_around(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, lost_between(41, 42));
+    TEST_ASSERT_EQUAL_UINT32(3, lost_between(41, 45));
+    TEST_ASSERT_EQUAL_UINT32(0, lost_between(0xFFFFFFFF, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, lost_between(0xFFFFFFFE, 1));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_header_round_trip);
+    RUN_TEST(test_decode_rejects_foreign_data);
+    RUN_TEST(test_loss_across_wrap_around);
+
+    return UNITY_END();
+}
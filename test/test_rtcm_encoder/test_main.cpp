@@ -0,0 +1,131 @@
+#include <unity.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "network/rtcm_encoder.h"
+#include "network/rtcmbuffer.h"
+
+using namespace rtcm_encoder;
+
+// Example 1005 from the RTCM 10403 standard: station 2003, GPS only,
+// ARP X = 1114104.5999 m, Y = -4850729.7108 m, Z = 3975521.4643 m
+static const uint8_t EXAMPLE_1005[] = {
+    0xD3, 0x00, 0x13, 0x3E, 0xD7, 0xD3, 0x02, 0x02, 0x98, 0x0E, 0xDE, 0xEF, 0x34,
+    0xB4, 0xBD, 0x62, 0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33, 0x36, 0x0B, 0x98
+};
+
+// Same station as 1006 with GLONASS and a 1.2345 m antenna height
+static const uint8_t EXAMPLE_1006[] = {
+    0xD3, 0x00, 0x15, 0x3E, 0xE7, 0xD3, 0x03, 0x02, 0x98, 0x0E, 0xDE, 0xEF, 0x34,
+    0xB4, 0xBD, 0x62, 0xAC, 0x09, 0x41, 0x98, 0x6F, 0x33, 0x30, 0x39, 0xDC, 0xA7, 0x4A
+};
+
+// Station 2003 with a Trimble choke ring, setup 1, no antenna or receiver serial
+static const uint8_t EXAMPLE_1033[] = {
+    0xD3, 0x00, 0x33, 0x40, 0x97, 0xD3, 0x14, 0x54, 0x52, 0x4D, 0x35, 0x39, 0x38,
+    0x30, 0x30, 0x2E, 0x30, 0x30, 0x20, 0x20, 0x20, 0x20, 0x20, 0x4E, 0x4F, 0x4E,
+    0x45, 0x01, 0x00, 0x0E, 0x75, 0x2D, 0x62, 0x6C, 0x6F, 0x78, 0x20, 0x5A, 0x45,
+    0x44, 0x2D, 0x46, 0x39, 0x50, 0x08, 0x48, 0x50, 0x47, 0x20, 0x31, 0x2E, 0x33,
+    0x32, 0x00, 0x53, 0xF5, 0x2F
+};
+
+static ReceiverDescriptor example_descriptor(void) {
+    ReceiverDescriptor descriptor;
+    descriptor.station_id = 2003;
+    descriptor.antenna_descriptor = "TRM59800.00     NONE";
+    descriptor.antenna_setup_id = 1;
+    descriptor.antenna_serial = "";
+    descriptor.receiver_type = "u-blox ZED-F9P";
+    descriptor.receiver_firmware = "HPG 1.32";
+    descriptor.receiver_serial = "";
+    return descriptor;
+}
+
+static StationPosition example_station(void) {
+    StationPosition position;
+    position.station_id = 2003;
+    position.ecef_x = 11141045999LL;
+    position.ecef_y = -48507297108LL;
+    position.ecef_z = 39755214643LL;
+    position.antenna_height = 0;
+    position.gps = true;
+    position.glonass = false;
+    position.galileo = false;
+    return position;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_1005_matches_standard_example(void) {
+    uint8_t frame[MSG_1005_LEN];
+    const size_t len = encode_1005(example_station(), frame);
+    TEST_ASSERT_EQUAL_INT(sizeof(EXAMPLE_1005), (int)len);
+    TEST_ASSERT_EQUAL_MEMORY(EXAMPLE_1005, frame, sizeof(EXAMPLE_1005));
+}
+
+void test_1006_bit_exact(void) {
+    StationPosition position = example_station();
+    position.glonass = true;
+    position.antenna_height = 12345;
+    uint8_t frame[MSG_1006_LEN];
+    const size_t len = encode_1006(position, frame);
+    TEST_ASSERT_EQUAL_INT(sizeof(EXAMPLE_1006), (int)len);
+    TEST_ASSERT_EQUAL_MEMORY(EXAMPLE_1006, frame, sizeof(EXAMPLE_1006));
+}
+
+// Encoded frames pass the same header and type checks as receiver frames
+void test_frames_parse_back(void) {
+    uint8_t frame[MSG_1006_LEN];
+    encode_1005(example_station(), frame);
+    TEST_ASSERT_EQUAL_INT(MSG_1005_LEN - FRAME_OVERHEAD, rtcmbuffer::parse_rtcm_length(frame));
+    TEST_ASSERT_EQUAL_INT(1005, rtcmbuffer::get_rtcm_message_type(&frame[3]));
+
+    encode_1006(example_station(), frame);
+    TEST_ASSERT_EQUAL_INT(MSG_1006_LEN - FRAME_OVERHEAD, rtcmbuffer::parse_rtcm_length(frame));
+    TEST_ASSERT_EQUAL_INT(1006, rtcmbuffer::get_rtcm_message_type(&frame[3]));
+}
+
+void test_1033_bit_exact(void) {
+    uint8_t frame[MSG_1033_MAX_LEN];
+    const size_t len = encode_1033(example_descriptor(), frame);
+    TEST_ASSERT_EQUAL_INT(sizeof(EXAMPLE_1033), (int)len);
+    TEST_ASSERT_EQUAL_MEMORY(EXAMPLE_1033, frame, sizeof(EXAMPLE_1033));
+    TEST_ASSERT_EQUAL_INT(len - FRAME_OVERHEAD, rtcmbuffer::parse_rtcm_length(frame));
+    TEST_ASSERT_EQUAL_INT(1033, rtcmbuffer::get_rtcm_message_type(&frame[3]));
+}
+
+// Over-long strings are cut to 31 characters so the frame stays within MSG_1033_MAX_LEN
+void test_1033_truncates_strings(void) {
+    const char *longest = "0123456789012345678901234567890123456789";
+    ReceiverDescriptor descriptor = {0, longest, 0, longest, longest, longest, longest};
+    uint8_t frame[MSG_1033_MAX_LEN];
+    TEST_ASSERT_EQUAL_INT(MSG_1033_MAX_LEN, (int)encode_1033(descriptor, frame));
+    TEST_ASSERT_EQUAL_UINT8(MAX_DESCRIPTOR_LEN, frame[6]);
+}
+
+// Negative values are 38 bit two's complement, not sign-extended into the next field
+void test_signed_field_width(void) {
+    uint8_t buffer[2] = {0, 0};
+    BitWriter bits(buffer);
+    bits.put_signed(-1, 4);
+    bits.put(0, 4);
+    bits.put_signed(-2, 8);
+    TEST_ASSERT_EQUAL_UINT8(0xF0, buffer[0]);
+    TEST_ASSERT_EQUAL_UINT8(0xFE, buffer[1]);
+    TEST_ASSERT_EQUAL_INT(16, (int)bits.bits_written());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_1005_matches_standard_example);
+    RUN_TEST(test_1006_bit_exact);
+    RUN_TEST(test_frames_parse_back);
+    RUN_TEST(test_1033_bit_exact);
+    RUN_TEST(test_1033_truncates_strings);
+    RUN_TEST(test_signed_field_width);
+
+    return UNITY_END();
+}
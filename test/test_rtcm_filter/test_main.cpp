@@ -0,0 +1,169 @@
+#include <unity.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "network/rtcm_filter.h"
+
+static const int FRAME_LEN = 20;
+
+// Minimal frame of msg_type; for MSM, more sets the multiple message bit.
+// The filter doesn't check the CRC.
+static const uint8_t *frame(const int msg_type, const bool more = false) {
+    static uint8_t buffer[FRAME_LEN];
+    memset(buffer, 0, sizeof(buffer));
+    buffer[0] = 0xD3;
+    buffer[2] = FRAME_LEN - 6;
+    buffer[3] = msg_type >> 4;
+    buffer[4] = (msg_type & 0x0F) << 4;
+    if (more) {
+        buffer[3 + 6] = 0x02;  // Payload bit 54
+    }
+    return buffer;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_empty_allows_everything(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse(""));
+    TEST_ASSERT_TRUE(filter.pass(frame(1005), FRAME_LEN, 0));
+    TEST_ASSERT_TRUE(filter.pass(frame(1077), FRAME_LEN, 0));
+    TEST_ASSERT_TRUE(filter.pass(frame(999), FRAME_LEN, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, filter.frames_dropped());
+}
+
+// Later rules override earlier ones, bytes held back are counted
+void test_allow_deny_in_order(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("*=deny,1005=allow,msm4=allow,1094=deny"));
+    TEST_ASSERT_TRUE(filter.pass(frame(1005), FRAME_LEN, 0));
+    TEST_ASSERT_TRUE(filter.pass(frame(1074), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(1094), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(1077), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(4072), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(999), FRAME_LEN, 0));
+    TEST_ASSERT_TRUE(filter.denies(1230));
+    TEST_ASSERT_FALSE(filter.denies(1005));
+    TEST_ASSERT_EQUAL_UINT32(4, filter.frames_dropped());
+    TEST_ASSERT_EQUAL_UINT32(4 * FRAME_LEN, filter.bytes_saved());
+}
+
+void test_ranges_and_msm_groups(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("1001-1012=deny,msm=deny"));
+    TEST_ASSERT_FALSE(filter.pass(frame(1001), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(1012), FRAME_LEN, 0));
+    TEST_ASSERT_TRUE(filter.pass(frame(1013), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(1071), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(1137), FRAME_LEN, 0));
+    TEST_ASSERT_TRUE(filter.pass(frame(1078), FRAME_LEN, 0));  // Not an MSM
+}
+
+// Anything malformed leaves the filter allowing everything
+void test_rejects_bad_specs(void) {
+    RtcmFilter filter;
+    const char *bad[] = {"1005", "1005=", "1005=sometimes", "1005=0", "msm8=deny", "1077-1074=deny",
+                         "1300=deny", "1299-4001=deny", "abc=deny", "=deny", "1005=-5"};
+    for (const char *spec : bad) {
+        TEST_ASSERT_FALSE_MESSAGE(filter.parse(spec), spec);
+        TEST_ASSERT_TRUE_MESSAGE(filter.pass(frame(1005), FRAME_LEN, 0), spec);
+    }
+
+    char tooMany[256] = "";
+    for (int i = 0; i < RtcmFilter::MAX_RULES; i++) {
+        char rule[16];
+        snprintf(rule, sizeof(rule), "%s%d=1000", i ? "," : "", 1001 + i);
+        strcat(tooMany, rule);
+    }
+    TEST_ASSERT_FALSE(filter.parse(tooMany));
+}
+
+// A 1 Hz stream decimated to 5 s passes every 5th epoch despite arrival jitter
+void test_decimation_schedule(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("msm7=5000"));
+    const int32_t jitter_ms[] = {0, 30, -40, 10, -20, 45, -45, 0, 20, -10, 35, 0, -30, 15, 0, 5, -5, 0, 40, -40};
+    int passed = 0;
+    for (int second = 0; second < 20; second++) {
+        const uint32_t now_ms = 100000 + second * 1000 + jitter_ms[second];
+        const bool forwarded = filter.pass(frame(1077), FRAME_LEN, now_ms);
+        TEST_ASSERT_EQUAL_MESSAGE(second % 5 == 0, forwarded, "epoch");
+        passed += forwarded;
+    }
+    TEST_ASSERT_EQUAL_INT(4, passed);
+}
+
+// A faster stream averages out to the interval instead of drifting one frame per pass
+void test_decimation_rate(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("1230=1000"));
+    int passed = 0;
+    for (uint32_t now_ms = 0; now_ms < 60000; now_ms += 100) {
+        passed += filter.pass(frame(1230), FRAME_LEN, now_ms);
+    }
+    TEST_ASSERT_EQUAL_INT(60, passed);
+}
+
+// All frames of a passing epoch go out, also the ones that arrive after the first
+void test_decimation_keeps_epochs_whole(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("*=2000"));
+    for (int second = 0; second < 4; second++) {
+        const uint32_t now_ms = second * 1000;
+        const bool expected = second % 2 == 0;
+        TEST_ASSERT_EQUAL(expected, filter.pass(frame(1005), FRAME_LEN, now_ms));
+        TEST_ASSERT_EQUAL(expected, filter.pass(frame(1077, true), FRAME_LEN, now_ms + 5));
+        TEST_ASSERT_EQUAL(expected, filter.pass(frame(1087, true), FRAME_LEN, now_ms + 10));
+        TEST_ASSERT_EQUAL(expected, filter.pass(frame(1127, false), FRAME_LEN, now_ms + 15));
+    }
+}
+
+// Each decimating rule keeps its own schedule
+void test_rules_independent(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("msm7=1000,1005=10000"));
+    int msm = 0;
+    int arp = 0;
+    for (uint32_t now_ms = 0; now_ms < 30000; now_ms += 1000) {
+        arp += filter.pass(frame(1005), FRAME_LEN, now_ms);
+        msm += filter.pass(frame(1077), FRAME_LEN, now_ms + 5);
+    }
+    TEST_ASSERT_EQUAL_INT(30, msm);
+    TEST_ASSERT_EQUAL_INT(3, arp);
+}
+
+// After restart() the first epoch is decided afresh, not by the decision
+// for an epoch whose end went by while the output was down
+void test_restart_after_gap(void) {
+    RtcmFilter filter;
+    TEST_ASSERT_TRUE(filter.parse("*=2000"));
+    TEST_ASSERT_TRUE(filter.pass(frame(1077, false), FRAME_LEN, 0));
+    TEST_ASSERT_FALSE(filter.pass(frame(1077, true), FRAME_LEN, 1000));
+    // Disconnected before the end of that epoch, reconnected 4 s later
+    filter.restart();
+    TEST_ASSERT_TRUE(filter.pass(frame(1005), FRAME_LEN, 5000));
+    TEST_ASSERT_TRUE(filter.pass(frame(1077, true), FRAME_LEN, 5005));
+    TEST_ASSERT_TRUE(filter.pass(frame(1127, false), FRAME_LEN, 5010));
+    TEST_ASSERT_FALSE(filter.pass(frame(1077, false), FRAME_LEN, 6000));
+    TEST_ASSERT_TRUE(filter.pass(frame(1077, false), FRAME_LEN, 7000));
+    TEST_ASSERT_EQUAL_UINT32(2, filter.frames_dropped());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_allows_everything);
+    RUN_TEST(test_allow_deny_in_order);
+    RUN_TEST(test_ranges_and_msm_groups);
+    RUN_TEST(test_rejects_bad_specs);
+    RUN_TEST(test_decimation_schedule);
+    RUN_TEST(test_decimation_rate);
+    RUN_TEST(test_decimation_keeps_epochs_whole);
+    RUN_TEST(test_rules_independent);
+    RUN_TEST(test_restart_after_gap);
+
+    return UNITY_END();
+}
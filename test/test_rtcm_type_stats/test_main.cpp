@@ -0,0 +1,155 @@
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "network/rtcmbuffer.h"
+#include "network/rtcm_type_stats.h"
+#include "network/rtcm_encoder.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_counts_frames_and_bytes(void) {
+    RtcmTypeStats stats;
+    stats.add(1077, 400, 1000);
+    stats.add(1005, 25, 1005);
+    stats.add(1077, 420, 2000);
+
+    TEST_ASSERT_EQUAL_INT(2, stats.size());
+    const RtcmTypeStats::Entry &msm = stats.entry(0);
+    TEST_ASSERT_EQUAL_INT(1077, msm.msg_type);
+    TEST_ASSERT_EQUAL_UINT32(2, msm.frames);
+    TEST_ASSERT_EQUAL_UINT32(820, msm.bytes);
+    TEST_ASSERT_EQUAL_UINT32(2000, msm.last_ms);
+    TEST_ASSERT_EQUAL_INT(1005, stats.entry(1).msg_type);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.entry(1).frames);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.entry(1).last_interval_ms);
+}
+
+// Welford's running mean and standard deviation match the two-pass result
+void test_interval_mean_and_jitter(void) {
+    RtcmTypeStats stats;
+    const uint32_t intervals[] = {1000, 1010, 990, 1005, 995, 1040, 960, 1000};
+    const int n = sizeof(intervals) / sizeof(intervals[0]);
+    uint32_t now_ms = 0xFFFFF000u;  // Across the wrap of the ms counter
+    stats.add(1005, 25, now_ms);
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        now_ms += intervals[i];
+        stats.add(1005, 25, now_ms);
+        sum += intervals[i];
+    }
+    const double mean = sum / n;
+    double squares = 0;
+    for (int i = 0; i < n; i++) {
+        squares += (intervals[i] - mean) * (intervals[i] - mean);
+    }
+
+    const RtcmTypeStats::Entry &entry = stats.entry(0);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, (float)mean, entry.interval_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, (float)sqrt(squares / (n - 1)), entry.jitter_ms);
+    TEST_ASSERT_EQUAL_UINT32(1000, entry.last_interval_ms);
+    TEST_ASSERT_EQUAL_UINT32(960, entry.min_interval_ms);
+    TEST_ASSERT_EQUAL_UINT32(1040, entry.max_interval_ms);
+}
+
+// A 1005 schedule stretching from 10 s to 12 s moves the mean
+void test_drift_shows_in_mean(void) {
+    RtcmTypeStats stats;
+    uint32_t now_ms = 0;
+    for (int i = 0; i < 10; i++) {
+        stats.add(1005, 25, now_ms);
+        now_ms += 10000;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 10000.0f, stats.entry(0).interval_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, stats.entry(0).jitter_ms);
+    for (int i = 0; i < 10; i++) {
+        now_ms += 2000;
+        stats.add(1005, 25, now_ms);
+        now_ms += 10000;
+    }
+    TEST_ASSERT_TRUE(stats.entry(0).interval_ms > 10500.0f);
+    TEST_ASSERT_EQUAL_UINT32(12000, stats.entry(0).max_interval_ms);
+}
+
+void test_shared_entry_and_full_table(void) {
+    RtcmTypeStats stats;
+    stats.add(999, 10, 0);
+    stats.add(4096, 10, 0);
+    TEST_ASSERT_EQUAL_INT(1, stats.size());
+    TEST_ASSERT_EQUAL_INT(0, stats.entry(0).msg_type);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.entry(0).frames);
+
+    for (int i = 1; i < RtcmTypeStats::MAX_TYPES; i++) {
+        stats.add(1000 + i, 10, 0);
+    }
+    TEST_ASSERT_EQUAL_INT(RtcmTypeStats::MAX_TYPES, stats.size());
+    stats.add(4072, 10, 0);
+    stats.add(1001, 10, 0);
+    TEST_ASSERT_EQUAL_INT(RtcmTypeStats::MAX_TYPES, stats.size());
+    TEST_ASSERT_EQUAL_UINT32(1, stats.untracked_frames());
+    TEST_ASSERT_EQUAL_UINT32(2, stats.entry(1).frames);
+}
+
+// CRC errors only count against types already seen intact
+void test_crc_errors(void) {
+    RtcmTypeStats stats;
+    stats.crc_error(1077);
+    TEST_ASSERT_EQUAL_INT(0, stats.size());
+    stats.add(1077, 400, 0);
+    stats.crc_error(1077);
+    stats.crc_error(1077);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.entry(0).crc_errors);
+}
+
+struct NullSink {
+    void operator()(const uint8_t *, int) const {}
+};
+
+// Each framer feeds its own table: intact frames and a CRC failure of a known type
+void test_framer_feeds_table(void) {
+    uint8_t frame[64];
+    memset(frame, 0, sizeof(frame));
+    rtcm_encoder::BitWriter bits(frame + 3);
+    bits.put(1097, 12);
+    bits.put(0, 12 + 30 + 26);
+    const size_t len = rtcm_encoder::finish_frame(frame, (bits.bits_written() + 7) / 8);
+
+    RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, NullSink> framer;
+    framer.process_bytes(frame, len);
+    framer.process_bytes(frame, len);
+    frame[len - 1] ^= 0xFF;
+    framer.process_bytes(frame, len);
+
+    RtcmFramer<rtcmbuffer::MAX_FRAME_LEN, NullSink> other;
+    other.process_bytes(frame, len);
+    TEST_ASSERT_EQUAL_INT(0, other.get_type_stats().size());
+
+    const RtcmTypeStats &stats = framer.get_type_stats();
+    bool found = false;
+    for (int i = 0; i < stats.size(); i++) {
+        const RtcmTypeStats::Entry &entry = stats.entry(i);
+        if (entry.msg_type == 1097) {
+            found = true;
+            TEST_ASSERT_EQUAL_UINT32(2, entry.frames);
+            TEST_ASSERT_EQUAL_UINT32(2 * len, entry.bytes);
+            TEST_ASSERT_EQUAL_UINT32(1, entry.crc_errors);
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_counts_frames_and_bytes);
+    RUN_TEST(test_interval_mean_and_jitter);
+    RUN_TEST(test_drift_shows_in_mean);
+    RUN_TEST(test_shared_entry_and_full_table);
+    RUN_TEST(test_crc_errors);
+    RUN_TEST(test_framer_feeds_table);
+
+    return UNITY_END();
+}
@@ -0,0 +1,104 @@
+#include <unity.h>
+#include <stdint.h>
+
+#include "network/spsc_ring.h"
+
+typedef SpscRing<uint32_t, 4> Ring;
+
+static Ring* ring = nullptr;
+
+void setUp(void) {
+    ring = new Ring();
+}
+
+void tearDown(void) {
+    delete ring;
+    ring = nullptr;
+}
+
+void test_empty_pop_fails(void) {
+    uint32_t value = 0;
+    TEST_ASSERT_FALSE(ring->pop(value));
+    TEST_ASSERT_EQUAL_INT(0, (int)ring->size());
+}
+
+void test_fifo_order(void) {
+    for (uint32_t i = 1; i <= 3; i++) {
+        TEST_ASSERT_TRUE(ring->push(i));
+    }
+    uint32_t value = 0;
+    for (uint32_t i = 1; i <= 3; i++) {
+        TEST_ASSERT_TRUE(ring->pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+    }
+    TEST_ASSERT_FALSE(ring->pop(value));
+}
+
+// A full ring rejects new items without overwriting queued ones
+void test_full_ring_drops_new_items(void) {
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_TRUE(ring->push(i));
+    }
+    TEST_ASSERT_FALSE(ring->push(99));
+    TEST_ASSERT_FALSE(ring->push(100));
+    TEST_ASSERT_EQUAL_UINT32(2, ring->drop_count());
+
+    uint32_t value = 0;
+    TEST_ASSERT_TRUE(ring->pop(value));
+    TEST_ASSERT_EQUAL_UINT32(0, value);
+    TEST_ASSERT_TRUE(ring->push(4));
+}
+
+// Indexes keep counting past the capacity, order survives wrap-around
+void test_wrap_around(void) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < 1000; i++) {
+        TEST_ASSERT_TRUE(ring->push(i));
+        TEST_ASSERT_TRUE(ring->push(i + 1));
+        TEST_ASSERT_TRUE(ring->pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i, value);
+        TEST_ASSERT_TRUE(ring->pop(value));
+        TEST_ASSERT_EQUAL_UINT32(i + 1, value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, ring->drop_count());
+}
+
+// peek() returns the head item and leaves it queued
+void test_peek_keeps_item(void) {
+    uint32_t value = 0;
+    TEST_ASSERT_FALSE(ring->peek(value));
+    ring->push(7);
+    ring->push(8);
+    TEST_ASSERT_TRUE(ring->peek(value));
+    TEST_ASSERT_EQUAL_UINT32(7, value);
+    TEST_ASSERT_EQUAL_INT(2, (int)ring->size());
+    TEST_ASSERT_TRUE(ring->pop(value));
+    TEST_ASSERT_EQUAL_UINT32(7, value);
+    TEST_ASSERT_TRUE(ring->peek(value));
+    TEST_ASSERT_EQUAL_UINT32(8, value);
+}
+
+void test_high_water_mark(void) {
+    uint32_t value = 0;
+    ring->push(1);
+    ring->push(2);
+    ring->push(3);
+    ring->pop(value);
+    ring->pop(value);
+    ring->push(4);
+    TEST_ASSERT_EQUAL_UINT32(3, ring->high_water_mark());
+    TEST_ASSERT_EQUAL_INT(2, (int)ring->size());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_empty_pop_fails);
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_ring_drops_new_items);
+    RUN_TEST(test_wrap_around);
+    RUN_TEST(test_peek_keeps_item);
+    RUN_TEST(test_high_water_mark);
+
+    return UNITY_END();
+}